@@ -0,0 +1,236 @@
+//********************************************************
+// Allocations
+//
+// The replacement operator new and delete behind the
+// allocation counts, and the phase table. See
+// Allocations.h.
+//
+// Every block gets a 16 byte header in front of it, with
+// its size and the phase that allocated it, so that when
+// it's freed the right phase's live bytes go down. Blocks
+// with a bigger alignment get a bigger header, so the
+// block itself stays aligned, with the size and phase in
+// the 16 bytes just before it.
+//
+// The counters are atomics in a fixed table, so counting
+// never allocates or takes a lock.
+//********************************************************
+
+#include "Allocations.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+namespace
+{
+    // Phase 0 is for allocations made outside of any phase
+    constexpr int maxPhases = 64;
+
+    struct PhaseCounters
+    {
+        const char* name = nullptr;
+        std::atomic<uint64_t> allocations = 0;
+        std::atomic<uint64_t> bytes = 0;
+        std::atomic<int64_t> liveBytes = 0;
+        std::atomic<int64_t> peakLiveBytes = 0;
+    };
+
+    PhaseCounters phases[maxPhases];
+    PhaseCounters totals;
+    std::atomic<int> phaseCount = 1;
+    std::atomic<int> currentPhase = 0;
+    std::mutex registryMutex;
+
+    struct BlockHeader
+    {
+        uint64_t size;
+        uint32_t phase;
+        uint32_t unused;
+    };
+    static_assert(sizeof(BlockHeader) == 16, "The header has to keep blocks 16 byte aligned");
+
+    void raisePeak(std::atomic<int64_t>& peak, int64_t live)
+    {
+        int64_t seen = peak.load(std::memory_order_relaxed);
+        while (live > seen && !peak.compare_exchange_weak(seen, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void count(PhaseCounters& counters, int64_t size)
+    {
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+        raisePeak(counters.peakLiveBytes, counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+    }
+
+    // Fill in the header for a new block, and count it
+    void* track(void* base, size_t headerSize, size_t size)
+    {
+        const int phase = currentPhase.load(std::memory_order_relaxed);
+        void* block = static_cast<char*>(base) + headerSize;
+        const BlockHeader header = { size, static_cast<uint32_t>(phase), 0 };
+        std::memcpy(static_cast<char*>(block) - sizeof(BlockHeader), &header, sizeof(header));
+        count(phases[phase], static_cast<int64_t>(size));
+        count(totals, static_cast<int64_t>(size));
+        return block;
+    }
+
+    // Uncount a block that's being freed
+    void untrack(void* block)
+    {
+        BlockHeader header;
+        std::memcpy(&header, static_cast<char*>(block) - sizeof(BlockHeader), sizeof(header));
+        phases[header.phase].liveBytes.fetch_sub(static_cast<int64_t>(header.size), std::memory_order_relaxed);
+        totals.liveBytes.fetch_sub(static_cast<int64_t>(header.size), std::memory_order_relaxed);
+    }
+
+    void* allocate(size_t size)
+    {
+        void* base = std::malloc(sizeof(BlockHeader) + size);
+        return base == nullptr ? nullptr : track(base, sizeof(BlockHeader), size);
+    }
+
+    void release(void* block)
+    {
+        if (block == nullptr) return;
+        untrack(block);
+        std::free(static_cast<char*>(block) - sizeof(BlockHeader));
+    }
+
+    void* allocateAligned(size_t size, std::align_val_t alignment)
+    {
+        const size_t headerSize = std::max(sizeof(BlockHeader), static_cast<size_t>(alignment));
+#ifdef _WIN32
+        void* base = _aligned_malloc(headerSize + size, static_cast<size_t>(alignment));
+#else
+        const size_t rounded = (headerSize + size + headerSize - 1) / headerSize * headerSize;
+        void* base = std::aligned_alloc(static_cast<size_t>(alignment), rounded);
+#endif
+        return base == nullptr ? nullptr : track(base, headerSize, size);
+    }
+
+    void releaseAligned(void* block, std::align_val_t alignment)
+    {
+        if (block == nullptr) return;
+        untrack(block);
+        void* base = static_cast<char*>(block) - std::max(sizeof(BlockHeader), static_cast<size_t>(alignment));
+#ifdef _WIN32
+        _aligned_free(base);
+#else
+        std::free(base);
+#endif
+    }
+
+    AllocationStats statsOf(const PhaseCounters& counters)
+    {
+        AllocationStats stats;
+        stats.allocations = counters.allocations.load();
+        stats.bytes = counters.bytes.load();
+        stats.liveBytes = counters.liveBytes.load();
+        stats.peakLiveBytes = counters.peakLiveBytes.load();
+        return stats;
+    }
+}
+
+AllocationStats allocationTotals()
+{
+    return statsOf(totals);
+}
+
+int allocationPhase(const char* name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const int count = phaseCount.load();
+    for (int phase = 1; phase < count; phase++)
+    {
+        if (phases[phase].name == name || std::strcmp(phases[phase].name, name) == 0) return phase;
+    }
+    if (count == maxPhases) return maxPhases - 1;
+
+    phases[count].name = name;
+    phaseCount.store(count + 1);
+    return count;
+}
+
+int enterAllocationPhase(int phase)
+{
+    return currentPhase.exchange(phase);
+}
+
+void printAllocationReport(std::ostream& out)
+{
+    auto printRow = [&](const char* name, const AllocationStats& stats)
+        {
+            out << "  " << std::left << std::setw(24) << name << std::right
+                << std::setw(14) << stats.allocations
+                << std::setw(18) << stats.bytes
+                << std::setw(18) << stats.peakLiveBytes << std::endl;
+        };
+
+    out << "Allocations:" << std::endl;
+    out << "  " << std::left << std::setw(24) << "phase" << std::right
+        << std::setw(14) << "allocations" << std::setw(18) << "bytes" << std::setw(18) << "peak live bytes" << std::endl;
+    const int count = phaseCount.load();
+    for (int phase = 0; phase < count; phase++)
+    {
+        const AllocationStats stats = statsOf(phases[phase]);
+        if (phase == 0 && stats.allocations == 0) continue;
+        printRow(phase == 0 ? "(no phase)" : phases[phase].name, stats);
+    }
+    printRow("total", allocationTotals());
+    out << "  (only operator new is counted, not TBB's own allocator, see Allocations.h)" << std::endl;
+}
+
+//-------------------------------------------------------------------
+// The replacements for every form of operator new and delete
+//-------------------------------------------------------------------
+void* operator new(size_t size)
+{
+    if (void* block = allocate(size)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* block = allocate(size)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* block = allocateAligned(size, alignment)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* block = allocateAligned(size, alignment)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* block) noexcept { release(block); }
+void operator delete[](void* block) noexcept { release(block); }
+void operator delete(void* block, size_t) noexcept { release(block); }
+void operator delete[](void* block, size_t) noexcept { release(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { release(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { release(block); }
+
+void operator delete(void* block, std::align_val_t alignment) noexcept { releaseAligned(block, alignment); }
+void operator delete[](void* block, std::align_val_t alignment) noexcept { releaseAligned(block, alignment); }
+void operator delete(void* block, size_t, std::align_val_t alignment) noexcept { releaseAligned(block, alignment); }
+void operator delete[](void* block, size_t, std::align_val_t alignment) noexcept { releaseAligned(block, alignment); }
+void operator delete(void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept { releaseAligned(block, alignment); }
+void operator delete[](void* block, std::align_val_t alignment, const std::nothrow_t&) noexcept { releaseAligned(block, alignment); }
@@ -0,0 +1,105 @@
+//********************************************************
+// Allocations
+//
+// Counting every allocation the program makes, how many
+// bytes they asked for, and how much memory was live at
+// the worst point, split up by named phases:
+//
+//     {
+//         AOC_ALLOC_PHASE("parse");
+//         ...
+//     }
+//     AOC_ALLOC_REPORT(std::cout);
+//
+// The counting is done by replacing the global operator
+// new and delete, which puts a small header in front of
+// every block to remember its size and phase. That only
+// happens in programs that use something from this file:
+// it all lives in one object file of the core library,
+// and the linker only pulls that in when it's needed.
+//
+// The macros only exist when the build is configured with
+// AOC_ALLOC_TRACKING on. Otherwise they expand to nothing
+// and no program pays for any of it. With it on, labelled
+// ScopedTimers print the allocations they saw next to
+// their time too (see ScopedTimer.h).
+//
+// There's one current phase for the whole program, not
+// one per thread, so that allocations made by the worker
+// threads inside a phase count towards it. Phases can be
+// nested, and the innermost one gets the allocations.
+// Names must be string literals, as only the pointer is
+// kept.
+//
+// Only memory that comes from operator new is seen. TBB
+// allocates its own tasks, and the blocks for its
+// containers, through its own allocator, which goes
+// straight to malloc (or tbbmalloc). ConcurrentMap
+// switches to std::allocator when tracking is on, so the
+// maps the engines build up are counted, but TBB's own
+// scheduling, and any other TBB container, are not.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+// What was allocated, either in total or in one phase
+struct AllocationStats
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    int64_t liveBytes = 0;
+    int64_t peakLiveBytes = 0;
+};
+
+// Everything allocated so far by the whole program
+AllocationStats allocationTotals();
+
+// The id of a phase, which is registered the first time its name is seen
+// There's room for 63 phases, and any after that all share the last one.
+int allocationPhase(const char* name);
+
+// Make a phase the current one, returning the one it replaces
+int enterAllocationPhase(int phase);
+
+// Print a table of every phase
+void printAllocationReport(std::ostream& out);
+
+//-------------------------------------------------------------------
+// This class makes a phase the current one for its whole lifetime
+//-------------------------------------------------------------------
+class AllocationPhase
+{
+public:
+
+    // Constructor
+    explicit AllocationPhase(int phase) : previous_(enterAllocationPhase(phase)) {};
+
+    // Goes back to the phase that was current before
+    ~AllocationPhase() { enterAllocationPhase(previous_); };
+
+    // Tied to the scope, so no copying
+    AllocationPhase(const AllocationPhase&) = delete;
+    AllocationPhase& operator=(const AllocationPhase&) = delete;
+
+private:
+    int previous_;
+};
+
+#ifdef AOC_ALLOC_TRACKING
+
+#define AOC_ALLOC_CONCAT_INNER(a, b) a##b
+#define AOC_ALLOC_CONCAT(a, b) AOC_ALLOC_CONCAT_INNER(a, b)
+#define AOC_ALLOC_PHASE(name) \
+    static const int AOC_ALLOC_CONCAT(allocationPhaseId, __LINE__) = allocationPhase(name); \
+    AllocationPhase AOC_ALLOC_CONCAT(allocationPhaseScope, __LINE__)(AOC_ALLOC_CONCAT(allocationPhaseId, __LINE__))
+#define AOC_ALLOC_REPORT(out) printAllocationReport(out)
+
+#else
+
+#define AOC_ALLOC_PHASE(name) ((void)0)
+#define AOC_ALLOC_REPORT(out) ((void)0)
+
+#endif
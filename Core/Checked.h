@@ -0,0 +1,57 @@
+//********************************************************
+// Checked
+//
+// Integer arithmetic that says when the result doesn't
+// fit, rather than overflowing (which is undefined for
+// signed integers). GCC and Clang have builtins for this
+// that compile down to the operation and a check of the
+// overflow flag. Other compilers, like MSVC, compare
+// against the limits first.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// Add b to a
+// Returns false, leaving a alone, if the sum doesn't fit in 64 bits
+inline bool checkedAdd(int64_t& a, int64_t b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int64_t sum;
+    if (__builtin_add_overflow(a, b, &sum)) return false;
+    a = sum;
+    return true;
+#else
+    if (b > 0 ? a > std::numeric_limits<int64_t>::max() - b : a < std::numeric_limits<int64_t>::min() - b) return false;
+    a += b;
+    return true;
+#endif
+}
+
+// Multiply a by b
+// Returns false, leaving a alone, if the product doesn't fit in 64 bits
+// This one is constexpr, as the compile time stone rules multiply with it.
+constexpr bool checkedMultiply(int64_t& a, int64_t b)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int64_t product = 0;
+    if (__builtin_mul_overflow(a, b, &product)) return false;
+    a = product;
+    return true;
+#else
+    constexpr int64_t max = std::numeric_limits<int64_t>::max();
+    constexpr int64_t min = std::numeric_limits<int64_t>::min();
+    if (a != 0 && b != 0)
+    {
+        // Compare against the limit divided by one side, so nothing here can overflow either
+        const bool fits = (a > 0) == (b > 0)
+            ? (a > 0 ? a <= max / b : a >= max / b)
+            : (a > 0 ? b >= min / a : a >= min / b);
+        if (!fits) return false;
+    }
+    a *= b;
+    return true;
+#endif
+}
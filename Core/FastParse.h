@@ -0,0 +1,150 @@
+//********************************************************
+// Fast Parse
+//
+// Integer parsing shared by all of the days. Everything
+// works directly on a buffer of characters (usually a
+// MappedFile), with no streams, no locales and no
+// copying.
+//
+// Integers are parsed with std::from_chars. When
+// AOC_SIMD_PARSE is defined, short runs of digits (up to
+// 8 of them, which covers nearly every number in our
+// inputs) are instead converted 8 characters at a time
+// inside a single 64 bit register, and only longer or
+// signed numbers fall back to std::from_chars.
+//********************************************************
+
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#ifdef AOC_SIMD_PARSE
+// Try to parse a run of up to 8 digits at p, where at least 8 characters are readable
+// Returns the number of digits parsed, or 0 if the number needs the slow path instead
+// (no digits, or a run of more than 8 digits)
+inline int parseDigitRun(const char* p, const char* end, uint32_t& value)
+{
+    // The byte tricks below need the first character to end up in the lowest byte
+    if constexpr (std::endian::native != std::endian::little) return 0;
+
+    // Load 8 characters
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+
+    // A byte is a digit if its high nibble is 3, and adding 6 doesn't change that
+    // Any carry out of a byte only happens for non-digits, and only moves into later bytes,
+    // so every byte before the first non-digit is classified correctly.
+    const uint64_t classes = (chunk & 0xF0F0F0F0F0F0F0F0ull) | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4);
+    const uint64_t nonDigits = classes ^ 0x3333333333333333ull;
+    const int digits = nonDigits == 0 ? 8 : std::countr_zero(nonDigits) / 8;
+    if (digits == 0) return 0;
+
+    // Longer numbers go to the slow path
+    if (digits == 8 && p + 8 < end && p[8] >= '0' && p[8] <= '9') return 0;
+
+    // Turn the characters into digit values, and shift them up so that the number is
+    // right aligned, with leading zeros filling in the low bytes
+    uint64_t x = (chunk - 0x3030303030303030ull) << (8 * (8 - digits));
+
+    // Combine neighbouring digits, then pairs of those, then pairs of those
+    x = (x * 10) + (x >> 8);
+    x = (((x & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) + (((x >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    value = static_cast<uint32_t>(x);
+    return digits;
+}
+#endif
+
+// Parse one integer starting exactly at p
+// Returns a pointer just past the integer, or nullptr if there wasn't a valid integer there
+template <typename T>
+const char* parseInteger(const char* p, const char* end, T& value)
+{
+    static_assert(std::is_integral_v<T>, "Only integers can be parsed");
+
+#ifdef AOC_SIMD_PARSE
+    // 8 digits always fit in anything 32 bits or wider
+    if constexpr (sizeof(T) >= 4)
+    {
+        if (end - p >= 8)
+        {
+            uint32_t digits;
+            const int length = parseDigitRun(p, end, digits);
+            if (length > 0)
+            {
+                value = static_cast<T>(digits);
+                return p + length;
+            }
+        }
+    }
+#endif
+
+    const auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return nullptr;
+    return result.ptr;
+}
+
+//-------------------------------------------------------------------
+// This class walks through a buffer of whitespace separated integers
+// a line at a time. It never allocates, and never copies the buffer.
+//
+//     IntegerScanner scanner(text);
+//     do {
+//         while (scanner.next(value)) { ... }
+//     } while (scanner.nextLine());
+//-------------------------------------------------------------------
+class IntegerScanner
+{
+public:
+
+    // Constructor
+    explicit IntegerScanner(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {};
+
+    // Read the next integer on the current line
+    // Returns false at the end of the line, or if there's something there that isn't an
+    // integer, in which case failed() is set
+    template <typename T>
+    bool next(T& value)
+    {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r')) p_++;
+        if (p_ == end_ || *p_ == '\n') return false;
+
+        const char* after = parseInteger(p_, end_, value);
+        if (after == nullptr)
+        {
+            failed_ = true;
+            return false;
+        }
+        p_ = after;
+        return true;
+    };
+
+    // Move on to the start of the next line, skipping anything left on this one
+    // Returns false if there are no more lines
+    bool nextLine()
+    {
+        const void* newline = std::memchr(p_, '\n', end_ - p_);
+        if (newline == nullptr)
+        {
+            p_ = end_;
+            return false;
+        }
+        p_ = static_cast<const char*>(newline) + 1;
+        line_++;
+        return p_ < end_;
+    };
+
+    // Getters
+    bool failed() const { return failed_; };
+    size_t line() const { return line_; };
+
+private:
+    const char* p_;
+    const char* end_;
+    size_t line_ = 1;
+    bool failed_ = false;
+};
@@ -0,0 +1,62 @@
+//********************************************************
+// Grid
+//
+// Reading grids in from text. See Grid.h.
+//********************************************************
+
+#include "Grid.h"
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+Grid Grid::load(const std::string& filename)
+{
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    return parse(file.view());
+}
+
+Grid Grid::parse(std::string_view text)
+{
+    Grid grid;
+
+    // The width comes from the first line, and every line after it has to match
+    // Blank lines at the end of the text are ignored, and so are Windows line endings.
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view line = text.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        start = end + 1;
+
+        if (line.empty())
+        {
+            // Only blank lines are allowed from here on
+            if (text.find_first_not_of("\r\n", start) != std::string_view::npos) {
+                throw std::runtime_error("Blank line inside grid after row " + std::to_string(grid.height_));
+            }
+            break;
+        }
+
+        if (grid.height_ == 0)
+        {
+            grid.width_ = static_cast<int>(line.size());
+
+            // Every line is about the same length, so this is enough to only allocate once
+            grid.cells_.reserve((text.size() / (line.size() + 1) + 1) * line.size());
+        }
+        else if (static_cast<int>(line.size()) != grid.width_)
+        {
+            throw std::runtime_error("Row " + std::to_string(grid.height_ + 1) + " has " + std::to_string(line.size()) + " cells, expected " + std::to_string(grid.width_));
+        }
+
+        grid.cells_.insert(grid.cells_.end(), line.begin(), line.end());
+        grid.height_++;
+    }
+
+    return grid;
+}
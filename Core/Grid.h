@@ -0,0 +1,92 @@
+//********************************************************
+// Grid
+//
+// A rectangular grid of characters, like the gardens in
+// Day 12. Every cell lives in one flat array, row after
+// row, so moving along a row is moving along memory, and
+// the whole grid is a single allocation.
+//********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The four directions, clockwise starting from up, as used by the neighbour accessors
+// Turning right is adding 1, turning left is adding 3, and rows go down.
+enum GridDirection { GridUp = 0, GridRight = 1, GridDown = 2, GridLeft = 3 };
+constexpr int gridRowStep[4] = { -1, 0, 1, 0 };
+constexpr int gridColStep[4] = { 0, 1, 0, -1 };
+
+class Grid
+{
+public:
+
+    // Constructors
+    // An empty grid, or one of the given size with every cell set to fill
+    Grid() = default;
+    Grid(int width, int height, char fill = '.') : width_(width), height_(height), cells_(static_cast<size_t>(width) * height, fill) {};
+
+    // Read a grid from a file, one row per line
+    // Throws if the file can't be read, or if its rows aren't all the same length
+    static Grid load(const std::string& filename);
+
+    // Read a grid from text, one row per line
+    // Throws if the rows aren't all the same length
+    static Grid parse(std::string_view text);
+
+    // Getters
+    int width() const { return width_; };
+    int height() const { return height_; };
+    size_t size() const { return cells_.size(); };
+    bool empty() const { return cells_.empty(); };
+    const char* data() const { return cells_.data(); };
+
+    // Is this cell inside the grid?
+    bool inBounds(int row, int col) const { return row >= 0 && row < height_ && col >= 0 && col < width_; };
+
+    // Where a cell is in the flat array
+    size_t index(int row, int col) const { return static_cast<size_t>(row) * width_ + col; };
+
+    // Which cell is at a place in the flat array
+    int rowOf(size_t i) const { return static_cast<int>(i / width_); };
+    int colOf(size_t i) const { return static_cast<int>(i % width_); };
+
+    // Where the neighbour of cell i, which is at (row, col), is in the flat array
+    // There's no bounds checking, the neighbour has to be inside the grid.
+    size_t neighbour(size_t i, int row, int col, GridDirection direction) const
+    {
+        (void)row;
+        (void)col;
+        return i + gridColStep[direction] + static_cast<ptrdiff_t>(gridRowStep[direction]) * width_;
+    };
+
+    // Call f(i, row, col) for every cell, in the order they're stored
+    template <typename F>
+    void forEachCell(F f) const
+    {
+        size_t i = 0;
+        for (int row = 0; row < height_; row++)
+        {
+            for (int col = 0; col < width_; col++)
+            {
+                f(i++, row, col);
+            }
+        }
+    };
+
+    // Cell access, with no bounds checking
+    char operator()(int row, int col) const { return cells_[index(row, col)]; };
+    char& operator()(int row, int col) { return cells_[index(row, col)]; };
+    char at(size_t i) const { return cells_[i]; };
+
+    // A whole row
+    std::string_view row(int r) const { return { cells_.data() + index(r, 0), static_cast<size_t>(width_) }; };
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<char> cells_;
+};
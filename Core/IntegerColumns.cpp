@@ -0,0 +1,50 @@
+//********************************************************
+// Integer Columns
+//
+// See IntegerColumns.h.
+//********************************************************
+
+#include "IntegerColumns.h"
+#include "MappedFile.h"
+#include "FastParse.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+size_t readIntegerColumns(std::string_view text, std::span<std::vector<int>* const> columns)
+{
+    // An empty file just has no rows
+    if (text.empty() || columns.empty()) return 0;
+
+    // Every row is a line, so counting the lines up front means each column only allocates once
+    const size_t lines = static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1;
+    for (auto* column : columns)
+    {
+        column->reserve(column->size() + lines);
+    }
+
+    size_t rows = 0;
+    IntegerScanner scanner(text);
+    do {
+        for (auto* column : columns)
+        {
+            int value;
+            if (!scanner.next(value)) {
+                throw std::runtime_error("Invalid line format on line " + std::to_string(scanner.line()));
+            }
+            column->push_back(value);
+        }
+        rows++;
+    } while (scanner.nextLine());
+
+    return rows;
+}
+
+size_t readIntegerColumnsFromFile(const std::string& filename, std::span<std::vector<int>* const> columns)
+{
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    return readIntegerColumns(file.view(), columns);
+}
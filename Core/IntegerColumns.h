@@ -0,0 +1,41 @@
+//********************************************************
+// Integer Columns
+//
+// Reading text made of rows of whitespace separated
+// integers, like the Day 1 input, into one array per
+// column. Every row must have exactly one integer per
+// column.
+//
+//     std::vector<int> left, right;
+//     readIntegerColumns(text, left, right);
+//********************************************************
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read rows of integers into columns, adding them to the end of each column
+// Returns the number of rows read, and throws if any row doesn't have one integer per column
+size_t readIntegerColumns(std::string_view text, std::span<std::vector<int>* const> columns);
+
+// Read rows of integers from a file into columns
+// Throws if the file can't be read, or if any row doesn't have one integer per column
+size_t readIntegerColumnsFromFile(const std::string& filename, std::span<std::vector<int>* const> columns);
+
+// The same, but with the columns given one by one
+template <typename... Columns>
+size_t readIntegerColumns(std::string_view text, std::vector<int>& first, Columns&... rest)
+{
+    std::vector<int>* columns[] = { &first, &rest... };
+    return readIntegerColumns(text, std::span<std::vector<int>* const>(columns));
+}
+
+template <typename... Columns>
+size_t readIntegerColumnsFromFile(const std::string& filename, std::vector<int>& first, Columns&... rest)
+{
+    std::vector<int>* columns[] = { &first, &rest... };
+    return readIntegerColumnsFromFile(filename, std::span<std::vector<int>* const>(columns));
+}
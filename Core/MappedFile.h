@@ -0,0 +1,101 @@
+//********************************************************
+// Mapped File
+//
+// A read-only view of a whole file, memory mapped so
+// that nothing gets copied. The parsers can then work
+// directly on the file's bytes as one big string_view.
+//********************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+
+    // Constructor
+    // Maps the whole file in, check isOpen() to see if that worked
+    explicit MappedFile(const std::string& filename)
+    {
+#ifdef _WIN32
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) return;
+        size_ = static_cast<size_t>(size.QuadPart);
+        open_ = true;
+
+        // An empty file can't be mapped, but it's still a perfectly good empty view
+        if (size_ == 0) return;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr) { open_ = false; return; }
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (data_ == nullptr) open_ = false;
+#else
+        file_ = ::open(filename.c_str(), O_RDONLY);
+        if (file_ < 0) return;
+
+        struct stat info;
+        if (fstat(file_, &info) != 0) return;
+        size_ = static_cast<size_t>(info.st_size);
+        open_ = true;
+
+        // An empty file can't be mapped, but it's still a perfectly good empty view
+        if (size_ == 0) return;
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+        if (data == MAP_FAILED) { open_ = false; return; }
+        data_ = static_cast<const char*>(data);
+
+        // We almost always read front to back, so let the kernel read ahead
+        madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+    };
+
+    // The mapping can't be shared, so no copying
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (data_ != nullptr) UnmapViewOfFile(data_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+        if (file_ >= 0) ::close(file_);
+#endif
+    };
+
+    // Getters
+    bool isOpen() const { return open_; };
+    size_t size() const { return size_; };
+    std::string_view view() const { return { data_ == nullptr ? "" : data_, data_ == nullptr ? 0 : size_ }; };
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int file_ = -1;
+#endif
+};
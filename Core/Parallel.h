@@ -0,0 +1,476 @@
+//********************************************************
+// Parallel
+//
+// The parallel building blocks the engines are written
+// against, so that they don't depend on any one
+// threading library:
+// - parallelFor: run a body over chunks of a range
+// - parallelReduce: combine the results of every chunk
+// - parallelScan: running totals across every chunk
+// - parallelSort: sort a random access range
+// - parallelInvoke: run two bodies at the same time
+// - parallelPipeline: read items in order, work on them
+//   in parallel, and collect the results
+// - parallelIsolate: keep a thread out of other work while it waits
+// - ConcurrentMap: a hash map many threads can share
+//
+// What runs underneath is picked when the build is
+// configured, with the AOC_PARALLEL_BACKEND option:
+// - TBB: Intel's Threading Building Blocks (the default)
+// - STD: the C++17 parallel algorithms
+// - OPENMP: OpenMP
+// - SERIAL: plain loops on the calling thread
+//
+// A body is always handed a half open range [first, last)
+// to work on, never a single index, so that the cost of
+// getting to the body is paid once per chunk. Chunks are
+// at least grainSize long, apart from the last one.
+//
+// Reductions combine chunk results in whatever order the
+// backend likes, so the combine has to be associative
+// and commutative (like adding up integer counts).
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(AOC_PARALLEL_TBB) && !defined(AOC_PARALLEL_STD) && !defined(AOC_PARALLEL_OPENMP) && !defined(AOC_PARALLEL_SERIAL)
+#define AOC_PARALLEL_TBB
+#endif
+
+#if defined(AOC_PARALLEL_TBB)
+#include <tbb/tbb.h>
+#elif defined(AOC_PARALLEL_STD)
+#include <execution>
+#elif defined(AOC_PARALLEL_OPENMP)
+#include <omp.h>
+#endif
+
+// The name of the backend this build uses
+#if defined(AOC_PARALLEL_TBB)
+constexpr const char* parallelBackendName = "TBB";
+#elif defined(AOC_PARALLEL_STD)
+constexpr const char* parallelBackendName = "std::execution";
+#elif defined(AOC_PARALLEL_OPENMP)
+constexpr const char* parallelBackendName = "OpenMP";
+#else
+constexpr const char* parallelBackendName = "serial";
+#endif
+
+//-------------------------------------------------------------------
+// This class splits a range into chunks of at least grainSize, for
+// the backends that don't do their own splitting.
+//-------------------------------------------------------------------
+class ParallelChunks
+{
+public:
+
+    // Constructor
+    ParallelChunks(size_t begin, size_t end, size_t grainSize) : begin_(begin), end_(end), grain_(std::max<size_t>(grainSize, 1))
+    {
+        count_ = end > begin ? (end - begin + grain_ - 1) / grain_ : 0;
+    };
+
+    // Getters
+    size_t count() const { return count_; };
+    size_t first(size_t chunk) const { return begin_ + chunk * grain_; };
+    size_t last(size_t chunk) const { return std::min(end_, first(chunk) + grain_); };
+
+    // Every chunk number, for the algorithms that want something to iterate over
+    std::vector<size_t> indices() const
+    {
+        std::vector<size_t> chunks(count_);
+        std::iota(chunks.begin(), chunks.end(), size_t(0));
+        return chunks;
+    };
+
+private:
+    size_t begin_;
+    size_t end_;
+    size_t grain_;
+    size_t count_;
+};
+
+// Call body(first, last) on chunks covering [begin, end), in parallel
+template <typename Body>
+void parallelFor(size_t begin, size_t end, size_t grainSize, const Body& body)
+{
+    if (end <= begin) return;
+
+#if defined(AOC_PARALLEL_TBB)
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end, std::max<size_t>(grainSize, 1)), [&](const tbb::blocked_range<size_t>& range)
+        {
+            body(range.begin(), range.end());
+        });
+#elif defined(AOC_PARALLEL_STD)
+    const ParallelChunks chunks(begin, end, grainSize);
+    const std::vector<size_t> indices = chunks.indices();
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t chunk)
+        {
+            body(chunks.first(chunk), chunks.last(chunk));
+        });
+#elif defined(AOC_PARALLEL_OPENMP)
+    const ParallelChunks chunks(begin, end, grainSize);
+    const long long count = static_cast<long long>(chunks.count());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (long long chunk = 0; chunk < count; chunk++)
+    {
+        body(chunks.first(static_cast<size_t>(chunk)), chunks.last(static_cast<size_t>(chunk)));
+    }
+#else
+    (void)grainSize;
+    body(begin, end);
+#endif
+}
+
+// Reduce [begin, end) in parallel
+// body(first, last, value) adds chunk [first, last) to value and returns the result, and
+// combine(a, b) joins two results together. identity is the result of an empty range.
+template <typename T, typename Body, typename Combine>
+T parallelReduce(size_t begin, size_t end, size_t grainSize, T identity, const Body& body, const Combine& combine)
+{
+    if (end <= begin) return identity;
+
+#if defined(AOC_PARALLEL_TBB)
+    return tbb::parallel_reduce(tbb::blocked_range<size_t>(begin, end, std::max<size_t>(grainSize, 1)), identity,
+        [&](const tbb::blocked_range<size_t>& range, T value)
+        {
+            return body(range.begin(), range.end(), std::move(value));
+        },
+        combine);
+#elif defined(AOC_PARALLEL_STD)
+    const ParallelChunks chunks(begin, end, grainSize);
+    const std::vector<size_t> indices = chunks.indices();
+    return std::transform_reduce(std::execution::par, indices.begin(), indices.end(), identity, combine, [&](size_t chunk)
+        {
+            return body(chunks.first(chunk), chunks.last(chunk), identity);
+        });
+#elif defined(AOC_PARALLEL_OPENMP)
+    // Every chunk gets its own result, and they're all combined at the end
+    const ParallelChunks chunks(begin, end, grainSize);
+    const long long count = static_cast<long long>(chunks.count());
+    std::vector<T> results(chunks.count(), identity);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (long long chunk = 0; chunk < count; chunk++)
+    {
+        results[chunk] = body(chunks.first(static_cast<size_t>(chunk)), chunks.last(static_cast<size_t>(chunk)), identity);
+    }
+    T value = identity;
+    for (auto& result : results)
+    {
+        value = combine(std::move(value), std::move(result));
+    }
+    return value;
+#else
+    (void)grainSize;
+    (void)combine;
+    return body(begin, end, identity);
+#endif
+}
+
+// Prefix sum (scan) over [begin, end) in parallel
+// body(first, last, sum, isFinalScan) adds chunk [first, last) to sum, which holds the total of
+// everything before the chunk, and returns the result. It's called with isFinalScan false when
+// only the chunk's total is wanted, and true when it should also write out its running totals.
+// combine(a, b) joins the totals of two neighbouring pieces, with a coming first. identity is
+// the total of an empty range.
+// Without TBB, every chunk is first totalled in parallel, the chunk totals are scanned on the
+// calling thread, and then every chunk does its final scan in parallel.
+template <typename T, typename Body, typename Combine>
+T parallelScan(size_t begin, size_t end, size_t grainSize, T identity, const Body& body, const Combine& combine)
+{
+    if (end <= begin) return identity;
+
+#if defined(AOC_PARALLEL_TBB)
+    return tbb::parallel_scan(tbb::blocked_range<size_t>(begin, end, std::max<size_t>(grainSize, 1)), identity,
+        [&](const tbb::blocked_range<size_t>& range, T sum, bool isFinalScan)
+        {
+            return body(range.begin(), range.end(), std::move(sum), isFinalScan);
+        },
+        combine);
+#elif defined(AOC_PARALLEL_SERIAL)
+    (void)grainSize;
+    (void)combine;
+    return body(begin, end, identity, true);
+#else
+    const ParallelChunks chunks(begin, end, grainSize);
+    std::vector<T> starts(chunks.count(), identity);
+    parallelFor(0, chunks.count(), 1, [&](size_t firstChunk, size_t lastChunk)
+        {
+            for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+            {
+                starts[chunk] = body(chunks.first(chunk), chunks.last(chunk), identity, false);
+            }
+        });
+
+    // Each chunk starts from the total of every chunk before it
+    T sum = identity;
+    for (auto& start : starts)
+    {
+        T total = std::move(start);
+        start = sum;
+        sum = combine(std::move(sum), std::move(total));
+    }
+
+    parallelFor(0, chunks.count(), 1, [&](size_t firstChunk, size_t lastChunk)
+        {
+            for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+            {
+                body(chunks.first(chunk), chunks.last(chunk), starts[chunk], true);
+            }
+        });
+    return sum;
+#endif
+}
+
+// Sort [first, last) in parallel
+template <typename Iterator, typename Compare = std::less<>>
+void parallelSort(Iterator first, Iterator last, Compare compare = {})
+{
+#if defined(AOC_PARALLEL_TBB)
+    tbb::parallel_sort(first, last, compare);
+#elif defined(AOC_PARALLEL_STD)
+    std::sort(std::execution::par, first, last, compare);
+#elif defined(AOC_PARALLEL_OPENMP)
+    // Sort one piece per thread, then merge neighbouring pieces together in pairs until
+    // there's only one left
+    const ptrdiff_t n = last - first;
+    const int pieces = omp_get_max_threads();
+    if (pieces <= 1 || n < (ptrdiff_t(1) << 14))
+    {
+        std::sort(first, last, compare);
+        return;
+    }
+
+    std::vector<ptrdiff_t> bounds(pieces + 1);
+    for (int p = 0; p <= pieces; p++)
+    {
+        bounds[p] = n * p / pieces;
+    }
+
+#pragma omp parallel for
+    for (int p = 0; p < pieces; p++)
+    {
+        std::sort(first + bounds[p], first + bounds[p + 1], compare);
+    }
+
+    for (int width = 1; width < pieces; width *= 2)
+    {
+#pragma omp parallel for
+        for (int p = 0; p < pieces; p += 2 * width)
+        {
+            if (p + width < pieces)
+            {
+                std::inplace_merge(first + bounds[p], first + bounds[p + width], first + bounds[std::min(p + 2 * width, pieces)], compare);
+            }
+        }
+    }
+#else
+    std::sort(first, last, compare);
+#endif
+}
+
+// Run left and right at the same time, returning once both are done
+template <typename Left, typename Right>
+void parallelInvoke(const Left& left, const Right& right)
+{
+#if defined(AOC_PARALLEL_TBB)
+    tbb::parallel_invoke(left, right);
+#elif defined(AOC_PARALLEL_SERIAL)
+    left();
+    right();
+#else
+    parallelFor(0, 2, 1, [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                if (i == 0) left(); else right();
+            }
+        });
+#endif
+}
+
+// Run a three stage pipeline over a stream of items, with at most inFlight items on the go
+// - read(item) fills in the next item, and returns false once there are none left. It's only
+//   ever called by one thread at a time, in order.
+// - work(item) turns an item into a result, on whichever thread is free.
+// - collect(result) is handed every result, one at a time, in whatever order they finish.
+// So the memory used is bounded by inFlight items and results, however long the stream is.
+// Without TBB the stages don't overlap: up to inFlight items are read, worked on in parallel,
+// and collected, and then the next batch is read.
+template <typename Item, typename Read, typename Work, typename Collect>
+void parallelPipeline(size_t inFlight, const Read& read, const Work& work, const Collect& collect)
+{
+    using Result = std::invoke_result_t<const Work&, Item>;
+    inFlight = std::max<size_t>(inFlight, 1);
+
+#if defined(AOC_PARALLEL_TBB)
+    tbb::parallel_pipeline(inFlight,
+        tbb::make_filter<void, Item>(tbb::filter_mode::serial_in_order,
+            [&](tbb::flow_control& fc)
+            {
+                Item item{};
+                if (!read(item)) fc.stop();
+                return item;
+            }) &
+        tbb::make_filter<Item, Result>(tbb::filter_mode::parallel,
+            [&](Item item)
+            {
+                return work(std::move(item));
+            }) &
+        tbb::make_filter<Result, void>(tbb::filter_mode::serial_out_of_order,
+            [&](const Result& result)
+            {
+                collect(result);
+            }));
+#else
+    std::vector<Item> items;
+    std::vector<Result> results;
+    bool more = true;
+    while (more)
+    {
+        items.clear();
+        while (items.size() < inFlight)
+        {
+            Item item{};
+            if (!read(item))
+            {
+                more = false;
+                break;
+            }
+            items.push_back(std::move(item));
+        }
+
+        results.resize(items.size());
+        parallelFor(0, items.size(), 1, [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                {
+                    results[i] = work(std::move(items[i]));
+                }
+            });
+        for (const auto& result : results)
+        {
+            collect(result);
+        }
+    }
+#endif
+}
+
+// Run body, without the calling thread picking up any unrelated parallel work while it waits
+// for the parallel work inside body to finish
+// This is needed whenever body holds a lock. With TBB, a thread waiting on its own parallelFor
+// can otherwise steal a task from someone else's, and if that task wants the same lock, the
+// thread ends up waiting on itself.
+template <typename Body>
+void parallelIsolate(const Body& body)
+{
+#if defined(AOC_PARALLEL_TBB)
+    tbb::this_task_arena::isolate(body);
+#else
+    body();
+#endif
+}
+
+//-------------------------------------------------------------------
+// This class is a hash map that any number of threads can look up
+// and insert into at the same time. Nothing is ever erased.
+//
+// With TBB it's a tbb::concurrent_unordered_map. Otherwise the keys
+// are split across a number of shards, each a regular unordered_map
+// with its own reader/writer lock, so threads only wait on each
+// other when they hit the same shard.
+//-------------------------------------------------------------------
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentMap
+{
+public:
+
+    // Look up a key, copying its value out
+    // Returns false if the key isn't in the map
+    bool find(const Key& key, Value& value) const
+    {
+#if defined(AOC_PARALLEL_TBB)
+        const auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        value = it->second;
+        return true;
+#else
+        const Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        value = it->second;
+        return true;
+#endif
+    };
+
+    // Add a key, unless it's already there
+    // Returns the value in the map afterwards, which is the existing one if there was one
+    Value insert(const Key& key, const Value& value)
+    {
+#if defined(AOC_PARALLEL_TBB)
+        return map_.insert({ key, value }).first->second;
+#else
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.insert({ key, value }).first->second;
+#endif
+    };
+
+    // Number of keys in the map
+    size_t size() const
+    {
+#if defined(AOC_PARALLEL_TBB)
+        return map_.size();
+#else
+        size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total += shard.map.size();
+        }
+        return total;
+#endif
+    };
+
+private:
+#if defined(AOC_PARALLEL_TBB)
+    // TBB's containers allocate through tbb_allocator, which goes around operator new, so when
+    // allocations are being counted (see Allocations.h) the map uses std::allocator instead
+#ifdef AOC_ALLOC_TRACKING
+    tbb::concurrent_unordered_map<Key, Value, Hash, std::equal_to<Key>, std::allocator<std::pair<const Key, Value>>> map_;
+#else
+    tbb::concurrent_unordered_map<Key, Value, Hash> map_;
+#endif
+#else
+    static constexpr size_t shardBits = 6;
+    static constexpr size_t shardCount = size_t(1) << shardBits;
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+
+    // The hash is mixed before picking a shard, as plenty of hashes (like std::hash for
+    // integers) are just the key itself, and the shard comes from the top bits so that the map
+    // inside it still gets the low ones to itself
+    static size_t shardIndex(const Key& key) { return static_cast<size_t>((static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull) >> (64 - shardBits)); };
+    Shard& shardFor(const Key& key) { return shards_[shardIndex(key)]; };
+    const Shard& shardFor(const Key& key) const { return shards_[shardIndex(key)]; };
+
+    Shard shards_[shardCount];
+#endif
+};
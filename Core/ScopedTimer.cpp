@@ -0,0 +1,27 @@
+//********************************************************
+// Scoped Timer
+//
+// See ScopedTimer.h.
+//********************************************************
+
+#include "ScopedTimer.h"
+
+ScopedTimer::~ScopedTimer()
+{
+    if (!label_.empty())
+    {
+#ifdef AOC_ALLOC_TRACKING
+        const AllocationStats allocations = allocationTotals();
+        out_ << label_ << " time: " << elapsed() << " ms, " << allocations.allocations - startAllocations_.allocations << " allocations, "
+            << allocations.bytes - startAllocations_.bytes << " bytes" << std::endl;
+#else
+        out_ << label_ << " time: " << elapsed() << " ms" << std::endl;
+#endif
+    }
+}
+
+double ScopedTimer::elapsed() const
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::high_resolution_clock::now() - start_;
+    return time.count();
+}
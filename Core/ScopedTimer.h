@@ -0,0 +1,63 @@
+//********************************************************
+// Scoped Timer
+//
+// Times a block of code with the high resolution clock.
+// Give it a label and it prints how long it was alive
+// for when it goes out of scope, or leave the label off
+// and read elapsed() whenever it's needed.
+//
+//     {
+//         ScopedTimer timer("Solve");
+//         ...
+//     } // prints "Solve time: 12.3 ms"
+//
+// With AOC_ALLOC_TRACKING on, a labelled timer also
+// prints how many allocations were made, and how many
+// bytes they asked for, while it was running (see
+// Allocations.h).
+//********************************************************
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#ifdef AOC_ALLOC_TRACKING
+#include "Allocations.h"
+#endif
+
+class ScopedTimer
+{
+public:
+
+    // Constructor
+    // Starts timing straight away
+    explicit ScopedTimer(std::string label = "", std::ostream& out = std::cout) : label_(std::move(label)), out_(out), start_(std::chrono::high_resolution_clock::now())
+    {
+#ifdef AOC_ALLOC_TRACKING
+        startAllocations_ = allocationTotals();
+#endif
+    };
+
+    // Prints the time, if there's a label
+    ~ScopedTimer();
+
+    // Timers are tied to their scope, so no copying
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    // How long since the timer started, in milliseconds
+    double elapsed() const;
+
+    // Start timing again from now
+    void restart() { start_ = std::chrono::high_resolution_clock::now(); };
+
+private:
+    std::string label_;
+    std::ostream& out_;
+    std::chrono::high_resolution_clock::time_point start_;
+#ifdef AOC_ALLOC_TRACKING
+    AllocationStats startAllocations_;
+#endif
+};
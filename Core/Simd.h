@@ -0,0 +1,30 @@
+//********************************************************
+// SIMD
+//
+// Working out whether the AVX2 versions of the kernels
+// can be used, so every kernel picks its path the same
+// way:
+// - AOC_HAS_AVX2_PATH is defined when the compiler can
+//   build an AVX2 path at all
+// - AOC_AVX2_TARGET goes in front of a function that uses
+//   AVX2, so it can be built without turning AVX2 on for
+//   the whole program
+// - AOC_CPU_HAS_AVX2() says, at runtime, whether the CPU
+//   we're running on can actually run it
+//********************************************************
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define AOC_HAS_AVX2_PATH
+#define AOC_AVX2_TARGET __attribute__((target("avx2")))
+#define AOC_CPU_HAS_AVX2() __builtin_cpu_supports("avx2")
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define AOC_HAS_AVX2_PATH
+#define AOC_AVX2_TARGET
+#define AOC_CPU_HAS_AVX2() true
+#endif
+#endif
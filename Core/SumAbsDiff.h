@@ -0,0 +1,100 @@
+//********************************************************
+// Sum Abs Diff
+//
+// Adds up the absolute differences between two arrays of
+// ints, element by element, in exact integer arithmetic.
+//
+// The difference between two ints can need 33 bits, so
+// it isn't worked out as a - b. Instead it's the larger
+// of the two minus the smaller, which always fits in an
+// unsigned 32 bit number, and every one of those is then
+// widened to 64 bits before it's added up.
+//
+// With AVX2 this is done 8 elements at a time, using the
+// vector min and max, and widening into four 64 bit sums
+// per register. The AVX2 path is picked at runtime if the
+// CPU supports it, and the scalar path gives the same
+// answers. Big arrays are split into chunks that are
+// added up in parallel (see Parallel.h).
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include "Parallel.h"
+#include "Simd.h"
+
+// Which version of the kernel to use
+enum class AbsDiffKernel { Auto, Scalar, Avx2 };
+
+// Sum of |a[i] - b[i]| for i in [0, n)
+inline uint64_t sumAbsDiffScalar(const int* a, const int* b, size_t n)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += static_cast<uint32_t>(std::max(a[i], b[i])) - static_cast<uint32_t>(std::min(a[i], b[i]));
+    }
+    return sum;
+}
+
+#ifdef AOC_HAS_AVX2_PATH
+AOC_AVX2_TARGET inline uint64_t sumAbsDiffAvx2(const int* a, const int* b, size_t n)
+{
+    __m256i sum = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const __m256i difference = _mm256_sub_epi32(_mm256_max_epi32(x, y), _mm256_min_epi32(x, y));
+
+        // Widen each half to 64 bits, treating the differences as unsigned
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(difference)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(difference, 1)));
+    }
+
+    // Add the four lanes together, and whatever is left over the slow way
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumAbsDiffScalar(a + i, b + i, n - i);
+}
+#endif
+
+// Sum of the absolute differences between a and b, which must be the same size
+// Throws if they aren't
+inline uint64_t sumAbsDiff(std::span<const int> a, std::span<const int> b, AbsDiffKernel kernel = AbsDiffKernel::Auto)
+{
+    if (a.size() != b.size()) {
+        throw std::runtime_error("sumAbsDiff needs two arrays of the same size");
+    }
+
+    // Pick which kernel to use
+#ifdef AOC_HAS_AVX2_PATH
+    if (kernel == AbsDiffKernel::Auto) kernel = AOC_CPU_HAS_AVX2() ? AbsDiffKernel::Avx2 : AbsDiffKernel::Scalar;
+#else
+    kernel = AbsDiffKernel::Scalar;
+#endif
+    auto sumChunk = [&](size_t first, size_t last)
+        {
+#ifdef AOC_HAS_AVX2_PATH
+            if (kernel == AbsDiffKernel::Avx2) return sumAbsDiffAvx2(a.data() + first, b.data() + first, last - first);
+#endif
+            return sumAbsDiffScalar(a.data() + first, b.data() + first, last - first);
+        };
+
+    // Small arrays aren't worth handing out to other threads
+    constexpr size_t grainSize = size_t(1) << 16;
+    if (a.size() <= grainSize) return sumChunk(0, a.size());
+
+    return parallelReduce(size_t(0), a.size(), grainSize, uint64_t(0),
+        [&](size_t first, size_t last, uint64_t sum)
+        {
+            return sum + sumChunk(first, last);
+        },
+        [](uint64_t left, uint64_t right) { return left + right; });
+}
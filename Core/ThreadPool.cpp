@@ -0,0 +1,64 @@
+//********************************************************
+// Thread Pool
+//
+// The pool belongs to whichever parallel backend the
+// build uses (see Parallel.h). With TBB, limits are set
+// by holding on to a tbb::global_control, which applies
+// for as long as it exists. With OpenMP they're set on
+// the runtime directly. The C++ parallel algorithms have
+// no way of limiting them, and the serial backend only
+// ever has the one thread. See ThreadPool.h.
+//********************************************************
+
+#include "ThreadPool.h"
+#include "Parallel.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+
+#if defined(AOC_PARALLEL_TBB)
+namespace
+{
+    // The current limit, if there is one
+    std::unique_ptr<tbb::global_control> threadLimit;
+}
+#endif
+
+int threadCount()
+{
+#if defined(AOC_PARALLEL_TBB)
+    return static_cast<int>(tbb::global_control::active_value(tbb::global_control::max_allowed_parallelism));
+#elif defined(AOC_PARALLEL_STD)
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+#elif defined(AOC_PARALLEL_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+void setThreadCount(int count)
+{
+#if defined(AOC_PARALLEL_TBB)
+    threadLimit.reset();
+    if (count > 0)
+    {
+        threadLimit = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism, static_cast<size_t>(count));
+    }
+#elif defined(AOC_PARALLEL_OPENMP)
+    omp_set_num_threads(count > 0 ? count : omp_get_num_procs());
+#else
+    (void)count;
+#endif
+}
+
+void setThreadCountFromEnvironment()
+{
+    const char* value = std::getenv("AOC_THREADS");
+    if (value != nullptr && *value != '\0')
+    {
+        setThreadCount(std::atoi(value));
+    }
+}
@@ -0,0 +1,26 @@
+//********************************************************
+// Thread Pool
+//
+// Control over the threads that all of the parallel code
+// runs on. There's one pool shared by the whole program,
+// belonging to the parallel backend (see Parallel.h), and
+// by default it uses every core. The std::execution
+// backend can't be limited, and the serial one is always
+// a single thread.
+//
+// Setting the AOC_THREADS environment variable limits it,
+// for any program that calls setThreadCountFromEnvironment
+// at startup.
+//********************************************************
+
+#pragma once
+
+// How many threads the parallel code can use
+int threadCount();
+
+// Limit the parallel code to at most count threads
+// A count of 0 or less goes back to using every core.
+void setThreadCount(int count);
+
+// Limit the threads to AOC_THREADS, if it's set
+void setThreadCountFromEnvironment();
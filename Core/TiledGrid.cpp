@@ -0,0 +1,18 @@
+#include "TiledGrid.h"
+
+// Copy a row major grid into tiles
+// The padding past the edges of the grid is filled with '\0'
+TiledGrid::TiledGrid(const Grid& grid) : width_(grid.width()), height_(grid.height())
+{
+    tilesAcross_ = static_cast<size_t>((width_ + tileSize - 1) >> tileBits);
+    const size_t tilesDown = static_cast<size_t>((height_ + tileSize - 1) >> tileBits);
+    cells_.assign(tilesAcross_ * tilesDown * tileCells, '\0');
+
+    for (int i = 0; i < height_; i++)
+    {
+        for (int j = 0; j < width_; j++)
+        {
+            cells_[index(i, j)] = grid(i, j);
+        }
+    }
+}
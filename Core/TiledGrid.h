@@ -0,0 +1,158 @@
+//********************************************************
+// Tiled Grid
+//
+// The same grid of characters as Grid, but laid out in
+// memory in 64 by 64 tiles, with the cells inside each
+// tile in Z-order (Morton order), and the tiles one row
+// of tiles after another.
+//
+// In a row major grid, the cell above or below is a whole
+// row away in memory, so on wide grids every vertical
+// step is a cache miss. Here, a whole tile is only 4 KB,
+// and cells that are close together in any direction are
+// mostly close together in memory too.
+//
+// The Z-order index of a cell inside its tile is its
+// column and row with their bits interleaved, column bits
+// in the even places and row bits in the odd ones. Moving
+// to a neighbour inside the same tile is done directly on
+// the interleaved bits, without working the index out
+// from scratch. The grid is padded out to whole tiles,
+// so there is storage for cells that aren't in the grid,
+// which are never part of it.
+//
+// It has the same accessors as Grid, so that code which is
+// templated on the grid works with either.
+//********************************************************
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// Spread the 6 bits of x out into the even places, and the reverse
+constexpr size_t mortonSpread(int x)
+{
+    size_t v = static_cast<size_t>(x);
+    v = (v | (v << 4)) & 0x0F0F;
+    v = (v | (v << 2)) & 0x3333;
+    v = (v | (v << 1)) & 0x5555;
+    return v;
+}
+constexpr int mortonCompact(size_t v)
+{
+    v &= 0x5555;
+    v = (v | (v >> 1)) & 0x3333;
+    v = (v | (v >> 2)) & 0x0F0F;
+    v = (v | (v >> 4)) & 0x00FF;
+    return static_cast<int>(v);
+}
+
+// The same, looked up
+// The compact table is only filled in where the index has nothing in the odd places.
+inline constexpr auto mortonSpreadTable = [] { std::array<uint16_t, 64> t = {}; for (int x = 0; x < 64; x++) t[x] = static_cast<uint16_t>(mortonSpread(x)); return t; }();
+inline constexpr auto mortonCompactTable = [] { std::array<uint8_t, 4096> t = {}; for (int x = 0; x < 64; x++) t[mortonSpread(x)] = static_cast<uint8_t>(x); return t; }();
+
+class TiledGrid
+{
+public:
+
+    // Tiles are 2^tileBits cells on a side
+    static constexpr int tileBits = 6;
+    static constexpr int tileSize = 1 << tileBits;
+    static constexpr size_t tileCells = size_t(1) << (2 * tileBits);
+
+    // Constructors
+    // An empty grid, or a copy of a row major one
+    TiledGrid() = default;
+    explicit TiledGrid(const Grid& grid);
+
+    // Getters
+    int width() const { return width_; };
+    int height() const { return height_; };
+    size_t size() const { return cells_.size(); };
+    bool empty() const { return width_ == 0 || height_ == 0; };
+
+    // Is this cell inside the grid?
+    bool inBounds(int row, int col) const { return row >= 0 && row < height_ && col >= 0 && col < width_; };
+
+    // Where a cell is in the flat array
+    size_t index(int row, int col) const
+    {
+        const size_t tile = static_cast<size_t>(row >> tileBits) * tilesAcross_ + (col >> tileBits);
+        return (tile << (2 * tileBits)) | mortonSpreadTable[col & (tileSize - 1)] | (size_t(mortonSpreadTable[row & (tileSize - 1)]) << 1);
+    };
+
+    // Which cell is at a place in the flat array
+    int rowOf(size_t i) const { return static_cast<int>((i >> (2 * tileBits)) / tilesAcross_) * tileSize + mortonCompactTable[(i >> 1) & colBits]; };
+    int colOf(size_t i) const { return static_cast<int>((i >> (2 * tileBits)) % tilesAcross_) * tileSize + mortonCompactTable[i & colBits]; };
+
+    // Where the neighbour of cell i, which is at (row, col), is in the flat array
+    // There's no bounds checking, the neighbour has to be inside the grid. Inside a tile, adding
+    // or subtracting one from the column (or row) bits is done with the others filled with ones
+    // (or cleared), so the carry (or borrow) passes straight through them.
+    size_t neighbour(size_t i, int row, int col, GridDirection direction) const
+    {
+        const size_t within = i & withinTileMask;
+        const size_t tile = i & ~withinTileMask;
+        switch (direction)
+        {
+        case GridRight:
+            if ((col & (tileSize - 1)) == tileSize - 1) break;
+            return tile | (within & rowBits) | (((within | rowBits) + 1) & colBits);
+        case GridLeft:
+            if ((col & (tileSize - 1)) == 0) break;
+            return tile | (within & rowBits) | (((within & colBits) - 1) & colBits);
+        case GridDown:
+            if ((row & (tileSize - 1)) == tileSize - 1) break;
+            return tile | (within & colBits) | (((within | colBits) + 1) & rowBits);
+        case GridUp:
+            if ((row & (tileSize - 1)) == 0) break;
+            return tile | (within & colBits) | (((within & rowBits) - 1) & rowBits);
+        }
+
+        // Into the next tile over
+        return index(row + gridRowStep[direction], col + gridColStep[direction]);
+    };
+
+    // Call f(i, row, col) for every cell, in the order they're stored
+    // That's tile by tile, and in Z-order inside each tile, skipping the padding.
+    template <typename F>
+    void forEachCell(F f) const
+    {
+        size_t i = 0;
+        for (int tileRow = 0; tileRow < height_; tileRow += tileSize)
+        {
+            for (int tileCol = 0; tileCol < width_; tileCol += tileSize)
+            {
+                for (size_t within = 0; within < tileCells; within++, i++)
+                {
+                    const int row = tileRow + mortonCompactTable[(within >> 1) & colBits];
+                    const int col = tileCol + mortonCompactTable[within & colBits];
+                    if (row < height_ && col < width_) f(i, row, col);
+                }
+            }
+        }
+    };
+
+    // Cell access, with no bounds checking
+    char operator()(int row, int col) const { return cells_[index(row, col)]; };
+    char& operator()(int row, int col) { return cells_[index(row, col)]; };
+    char at(size_t i) const { return cells_[i]; };
+
+private:
+
+    // Which bits of an index are the cell inside its tile, and which of those are the column
+    // and which the row
+    static constexpr size_t withinTileMask = tileCells - 1;
+    static constexpr size_t colBits = 0x5555555555555555ull & withinTileMask;
+    static constexpr size_t rowBits = 0xAAAAAAAAAAAAAAAAull & withinTileMask;
+
+    int width_ = 0;
+    int height_ = 0;
+    size_t tilesAcross_ = 0;
+    std::vector<char> cells_;
+};
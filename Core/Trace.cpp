@@ -0,0 +1,138 @@
+//********************************************************
+// Trace
+//
+// The per thread ring buffers behind the trace macros,
+// and writing them out as Chrome trace JSON. See Trace.h.
+//
+// Each thread's buffer is created the first time it
+// records an event, and registered in a global list so
+// that it can be saved later. Registering takes a lock,
+// but that only happens once per thread. The buffers
+// belong to the list, not the thread, so the events of
+// threads that have finished are still saved.
+//********************************************************
+
+#ifdef AOC_TRACE
+
+#include "Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // Events each thread keeps before it starts overwriting the oldest
+    constexpr size_t traceCapacity = size_t(1) << 16;
+
+    struct TraceEvent
+    {
+        const char* name;
+        int64_t arg;
+        int64_t start;
+        int64_t duration;
+    };
+
+    struct ThreadTrace
+    {
+        uint32_t thread = 0;
+        std::atomic<uint64_t> written = 0;
+        std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(traceCapacity);
+    };
+
+    const auto traceEpoch = std::chrono::steady_clock::now();
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadTrace>> registry;
+
+    // The calling thread's buffer, created on first use
+    ThreadTrace& threadTrace()
+    {
+        thread_local ThreadTrace* trace = nullptr;
+        if (trace == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.push_back(std::make_unique<ThreadTrace>());
+            trace = registry.back().get();
+            trace->thread = static_cast<uint32_t>(registry.size());
+        }
+        return *trace;
+    }
+
+    // Write a name as a JSON string
+    void writeName(std::ostream& out, const char* name)
+    {
+        out << '"';
+        for (const char* c = name; *c != '\0'; c++)
+        {
+            if (*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+int64_t traceClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void recordTrace(const char* name, int64_t arg, int64_t start, int64_t end)
+{
+    // Only this thread ever writes to its buffer, so all that's needed is to publish the
+    // new count after the event is in place
+    ThreadTrace& trace = threadTrace();
+    const uint64_t n = trace.written.load(std::memory_order_relaxed);
+    trace.events[n % traceCapacity] = { name, arg, start, end - start };
+    trace.written.store(n + 1, std::memory_order_release);
+}
+
+bool saveTrace(const std::string& filename)
+{
+    const char* override = std::getenv("AOC_TRACE_FILE");
+    const std::string path = override != nullptr && *override != '\0' ? override : filename;
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not write trace to " << path << std::endl;
+        return false;
+    }
+
+    // Chrome wants microseconds, and complete ("X") events carry their own duration
+    // They're written out to the nanosecond, in fixed point, as the default of 6 significant digits
+    // would round away the sub-microsecond part after 100 ms, and switch to exponents after 1 s
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& trace : registry)
+    {
+        const uint64_t written = trace->written.load(std::memory_order_acquire);
+        const uint64_t oldest = written > traceCapacity ? written - traceCapacity : 0;
+        for (uint64_t i = oldest; i < written; i++)
+        {
+            const TraceEvent& event = trace->events[i % traceCapacity];
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            writeName(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace->thread;
+            out << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0;
+            if (event.arg != noTraceArg) out << ",\"args\":{\"n\":" << event.arg << "}";
+            out << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        std::cerr << "Error: Could not write trace to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+//********************************************************
+// Trace
+//
+// Scoped tracing of the hot paths, saved as a Chrome
+// trace (open it in chrome://tracing or ui.perfetto.dev)
+// so that we can see a timeline of every phase on every
+// thread, and where the parallel code is stalling.
+//
+//     {
+//         AOC_TRACE_SCOPE("parse");
+//         ...
+//     }
+//     AOC_TRACE_SCOPE("blink", i);  // with a number attached
+//     ...
+//     AOC_TRACE_SAVE("Day11_trace.json");
+//
+// Tracing only exists when the build is configured with
+// AOC_TRACE on. Otherwise the macros expand to nothing,
+// and their arguments are never even evaluated.
+//
+// Each thread records into its own ring buffer, so
+// recording an event never takes a lock or touches
+// another thread's memory. If a thread records more
+// events than its buffer holds, the oldest ones are
+// overwritten. Names must be string literals, as only
+// the pointer is kept.
+//********************************************************
+
+#pragma once
+
+#ifdef AOC_TRACE
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// Marks an event that has no number attached
+constexpr int64_t noTraceArg = std::numeric_limits<int64_t>::min();
+
+// Nanoseconds since the program started
+int64_t traceClock();
+
+// Record an event on the calling thread
+void recordTrace(const char* name, int64_t arg, int64_t start, int64_t end);
+
+// Save every thread's events as a Chrome trace
+// The AOC_TRACE_FILE environment variable overrides the file name. Call this once the
+// parallel work is done, events still being recorded while saving may be missed.
+// Returns false, with an error printed, if the file couldn't be written.
+bool saveTrace(const std::string& filename);
+
+//-------------------------------------------------------------------
+// This class records an event covering its whole lifetime
+//-------------------------------------------------------------------
+class TraceScope
+{
+public:
+
+    // Constructor
+    explicit TraceScope(const char* name, int64_t arg = noTraceArg) : name_(name), arg_(arg), start_(traceClock()) {};
+
+    // Records the event
+    ~TraceScope() { recordTrace(name_, arg_, start_, traceClock()); };
+
+    // Tied to the scope, so no copying
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    int64_t arg_;
+    int64_t start_;
+};
+
+#define AOC_TRACE_CONCAT_INNER(a, b) a##b
+#define AOC_TRACE_CONCAT(a, b) AOC_TRACE_CONCAT_INNER(a, b)
+#define AOC_TRACE_SCOPE(...) TraceScope AOC_TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
+#define AOC_TRACE_SAVE(filename) saveTrace(filename)
+
+#else
+
+#define AOC_TRACE_SCOPE(...) ((void)0)
+#define AOC_TRACE_SAVE(filename) ((void)0)
+
+#endif
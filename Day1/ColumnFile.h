@@ -0,0 +1,279 @@
+//********************************************************
+// Column File
+//
+// Reading and writing the two columns of numbers that
+// Day 1 works on, either as the puzzle's text, or in a
+// binary columnar format that's much quicker to load.
+//
+// The binary format is a fixed size header, followed by
+// each column as its own array, starting on a 64 byte
+// boundary. A column is stored in one of two ways:
+// - Raw: the int32 values as they are. The file can be
+//   memory mapped and the columns used in place, so
+//   opening it costs the same no matter how big it is.
+// - Delta packed: the first value goes in the header,
+//   and every other value is stored as the difference
+//   from the one before it. The differences are zigzag
+//   encoded (0, -1, 1, -2, ... become 0, 1, 2, 3, ...) so
+//   small ones of either sign become small numbers, and
+//   then packed together using only as many bits each as
+//   the biggest one needs. This has to be decoded, but
+//   it's a single pass, and the file is much smaller.
+//
+// All of the numbers in the file are little endian.
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+#include "IntegerColumns.h"
+
+static_assert(sizeof(int) == sizeof(int32_t), "The columns are stored as int32");
+
+// How the columns in a file are stored
+enum class ColumnEncoding : uint32_t { Raw = 0, DeltaPacked = 1 };
+
+// The header at the start of every binary column file
+struct ColumnFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    ColumnEncoding encoding;
+    uint64_t rows;
+    struct Column
+    {
+        uint64_t offset;    // Where the column's data starts, from the start of the file
+        uint64_t bytes;     // How long the column's data is
+        int32_t first;      // The first value, for delta packed columns
+        uint32_t bitWidth;  // Bits per packed difference, for delta packed columns
+    } columns[2];
+};
+
+constexpr char columnFileMagic[8] = { 'A', 'O', 'C', 'C', 'O', 'L', 'S', '\0' };
+constexpr uint32_t columnFileVersion = 1;
+constexpr size_t columnFileAlignment = 64;
+
+// Does this look like a binary column file?
+inline bool isColumnFile(std::string_view bytes)
+{
+    return bytes.size() >= sizeof(ColumnFileHeader) && std::memcmp(bytes.data(), columnFileMagic, sizeof(columnFileMagic)) == 0;
+}
+
+// Zigzag encode a difference, so that small differences of either sign become small numbers
+inline uint32_t zigzagEncode(int32_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31); }
+inline int32_t zigzagDecode(uint32_t value) { return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1))); }
+
+// Pack the differences between neighbouring values of a column
+// Differences wrap around in 32 bits, so any two ints have one, and decoding wraps back.
+// There are 8 bytes of padding at the end, so that unpacking can always read a whole word.
+// Every difference takes at least one bit, even in a column of one value repeated, so that the
+// number of rows in a file is always bounded by its size.
+inline std::vector<uint8_t> packColumn(std::span<const int> column, uint32_t& bitWidth)
+{
+    std::vector<uint32_t> differences(column.size() > 0 ? column.size() - 1 : 0);
+    uint32_t widest = 0;
+    for (size_t i = 1; i < column.size(); i++)
+    {
+        const uint32_t difference = static_cast<uint32_t>(column[i]) - static_cast<uint32_t>(column[i - 1]);
+        differences[i - 1] = zigzagEncode(static_cast<int32_t>(difference));
+        widest |= differences[i - 1];
+    }
+    bitWidth = std::max<uint32_t>(1, static_cast<uint32_t>(std::bit_width(widest)));
+
+    std::vector<uint8_t> packed((differences.size() * bitWidth + 7) / 8 + 8, 0);
+    uint64_t bit = 0;
+    for (const uint32_t difference : differences)
+    {
+        // Each difference spans at most 5 bytes, so OR it in a byte at a time
+        uint64_t value = uint64_t(difference) << (bit % 8);
+        for (size_t byte = bit / 8; value != 0; byte++, value >>= 8)
+        {
+            packed[byte] |= static_cast<uint8_t>(value);
+        }
+        bit += bitWidth;
+    }
+    return packed;
+}
+
+// Unpack a delta packed column of rows values
+inline void unpackColumn(const uint8_t* packed, uint64_t rows, int32_t first, uint32_t bitWidth, std::vector<int>& column)
+{
+    column.resize(rows);
+    if (rows == 0) return;
+
+    const uint64_t mask = (uint64_t(1) << bitWidth) - 1;
+    uint32_t value = static_cast<uint32_t>(first);
+    column[0] = first;
+    uint64_t bit = 0;
+    for (uint64_t i = 1; i < rows; i++)
+    {
+        uint64_t word;
+        std::memcpy(&word, packed + bit / 8, sizeof(word));
+        const uint32_t difference = static_cast<uint32_t>((word >> (bit % 8)) & mask);
+        value += static_cast<uint32_t>(zigzagDecode(difference));
+        column[i] = static_cast<int>(value);
+        bit += bitWidth;
+    }
+}
+
+// Write two columns out as a binary column file
+// Throws if the file can't be written
+inline void writeColumnFile(const std::string& filename, std::span<const int> column1, std::span<const int> column2, ColumnEncoding encoding)
+{
+    static_assert(std::endian::native == std::endian::little, "Column files are written little endian");
+    if (column1.size() != column2.size()) {
+        throw std::runtime_error("Both columns must have the same number of rows");
+    }
+
+    ColumnFileHeader header = {};
+    std::memcpy(header.magic, columnFileMagic, sizeof(columnFileMagic));
+    header.version = columnFileVersion;
+    header.encoding = encoding;
+    header.rows = column1.size();
+
+    // Work out what goes in each column
+    std::vector<uint8_t> data[2];
+    const std::span<const int> columns[2] = { column1, column2 };
+    uint64_t offset = sizeof(ColumnFileHeader);
+    for (int c = 0; c < 2; c++)
+    {
+        if (encoding == ColumnEncoding::Raw)
+        {
+            const auto bytes = std::as_bytes(columns[c]);
+            data[c].assign(reinterpret_cast<const uint8_t*>(bytes.data()), reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size());
+        }
+        else
+        {
+            data[c] = packColumn(columns[c], header.columns[c].bitWidth);
+            header.columns[c].first = columns[c].empty() ? 0 : columns[c][0];
+        }
+
+        offset = (offset + columnFileAlignment - 1) / columnFileAlignment * columnFileAlignment;
+        header.columns[c].offset = offset;
+        header.columns[c].bytes = data[c].size();
+        offset += data[c].size();
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    for (int c = 0; c < 2; c++)
+    {
+        const std::vector<char> padding(header.columns[c].offset - written, 0);
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<const char*>(data[c].data()), data[c].size());
+        written = header.columns[c].offset + data[c].size();
+    }
+    if (!file) {
+        throw std::runtime_error("Could not write file: " + filename);
+    }
+}
+
+//-------------------------------------------------------------------
+// This class is a view of a binary column file that's already in
+// memory, usually a MappedFile. Raw columns can be used in place,
+// without copying them.
+//-------------------------------------------------------------------
+class ColumnView
+{
+public:
+
+    // Constructor
+    // Checks the header, and throws if the file isn't a valid column file
+    explicit ColumnView(std::string_view bytes) : bytes_(bytes)
+    {
+        if (!isColumnFile(bytes)) {
+            throw std::runtime_error("Not a column file");
+        }
+        std::memcpy(&header_, bytes.data(), sizeof(header_));
+        if (header_.version != columnFileVersion) {
+            throw std::runtime_error("Unsupported column file version " + std::to_string(header_.version));
+        }
+        if (header_.encoding != ColumnEncoding::Raw && header_.encoding != ColumnEncoding::DeltaPacked) {
+            throw std::runtime_error("Unknown column encoding");
+        }
+
+        for (const auto& column : header_.columns)
+        {
+            // Make sure the rows could fit in the file before working out how many bytes they
+            // take up, so that a corrupt row count can't wrap the multiplication around, or ask
+            // for a column far bigger than the file. Packed differences take at least a bit each,
+            // even if the header claims they take none.
+            const uint64_t differences = header_.rows > 0 ? header_.rows - 1 : 0;
+            const bool rowsFit = header_.encoding == ColumnEncoding::Raw ? header_.rows <= bytes.size() / sizeof(int32_t) : differences <= bytes.size() * 8 / std::max<uint32_t>(column.bitWidth, 1);
+            if (!rowsFit) {
+                throw std::runtime_error("Column file is truncated or corrupt");
+            }
+
+            const uint64_t needed = header_.encoding == ColumnEncoding::Raw ? header_.rows * sizeof(int32_t) : (differences * column.bitWidth + 7) / 8 + 8;
+            if (column.offset % alignof(int32_t) != 0 || column.bitWidth > 32 || column.bytes < needed || column.offset > bytes.size() || column.bytes > bytes.size() - column.offset) {
+                throw std::runtime_error("Column file is truncated or corrupt");
+            }
+        }
+    };
+
+    // Getters
+    uint64_t rows() const { return header_.rows; };
+    ColumnEncoding encoding() const { return header_.encoding; };
+
+    // A raw column, in place
+    // Only raw columns can be used like this, packed columns have to be read
+    std::span<const int> column(int c) const
+    {
+        if (header_.encoding != ColumnEncoding::Raw) {
+            throw std::runtime_error("Only raw columns can be viewed in place");
+        }
+        return { reinterpret_cast<const int*>(bytes_.data() + header_.columns[c].offset), static_cast<size_t>(header_.rows) };
+    };
+
+    // Copy or decode a column into a vector
+    void read(int c, std::vector<int>& values) const
+    {
+        if (header_.encoding == ColumnEncoding::Raw)
+        {
+            const std::span<const int> raw = column(c);
+            values.assign(raw.begin(), raw.end());
+        }
+        else
+        {
+            const auto& info = header_.columns[c];
+            unpackColumn(reinterpret_cast<const uint8_t*>(bytes_.data() + info.offset), header_.rows, info.first, info.bitWidth, values);
+        }
+    };
+
+private:
+    std::string_view bytes_;
+    ColumnFileHeader header_;
+};
+
+// Read the two columns from a file, which can be either text or a binary column file
+// Throws if the file can't be read
+inline void readTwoColumns(const std::string& filename, std::vector<int>& column1, std::vector<int>& column2) {
+    MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    // Binary column files are just copied or decoded
+    if (isColumnFile(file.view())) {
+        ColumnView columns(file.view());
+        columns.read(0, column1);
+        columns.read(1, column2);
+        return;
+    }
+
+    readIntegerColumns(file.view(), column1, column2);
+}
@@ -0,0 +1,131 @@
+//********************************************************
+// Historian Hysteria, column file check
+//
+// Author: Sahil Singh
+// Date: December 1 2024
+// https://adventofcode.com/2024/day/1
+//
+// Checks the binary column files (see ColumnFile.h):
+// - columns written in either encoding read back exactly
+// - headers that have been tampered with are rejected
+//   before anything is allocated or read for them,
+//   including row counts that would wrap the size check
+//   around, and packed columns that claim to take no
+//   bits at all
+//
+// It's registered with CTest as column_file.
+//
+// Usage: Day1ColumnFileCheck
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include "ColumnFile.h"
+
+int main()
+{
+    int failures = 0;
+    auto check = [&](const std::string& name, bool passed)
+        {
+            std::cout << name << ": " << (passed ? "ok" : "FAILED") << std::endl;
+            if (!passed) failures++;
+        };
+
+    // Some columns to write out: random numbers, and one of a single value repeated
+    std::mt19937 random(1);
+    std::vector<int> column1(1000), column2(1000);
+    for (auto& value : column1) value = static_cast<int>(random());
+    for (auto& value : column2) value = static_cast<int>(random() % 100);
+    const std::vector<int> repeated(1000, 42);
+
+    const std::string filename = (std::filesystem::temp_directory_path() / "aoc_column_file_check.bin").string();
+    const std::pair<std::string, ColumnEncoding> encodings[] = { { "raw", ColumnEncoding::Raw }, { "packed", ColumnEncoding::DeltaPacked } };
+    for (const auto& [encodingName, encoding] : encodings)
+    {
+        //----------------------------------------------------
+        // Round trips
+        //----------------------------------------------------
+        std::string bytes;
+        {
+            writeColumnFile(filename, column1, column2, encoding);
+            MappedFile file(filename);
+            bytes.assign(file.view());
+            std::vector<int> read1, read2;
+            const ColumnView view(bytes);
+            view.read(0, read1);
+            view.read(1, read2);
+            check(encodingName + " round trip", read1 == column1 && read2 == column2);
+        }
+        {
+            writeColumnFile(filename, repeated, repeated, encoding);
+            MappedFile file(filename);
+            std::vector<int> read1, read2;
+            const ColumnView view(file.view());
+            view.read(0, read1);
+            view.read(1, read2);
+            check(encodingName + " round trip of a repeated value", read1 == repeated && read2 == repeated);
+        }
+
+        //----------------------------------------------------
+        // Tampered headers
+        // Each change is made to a copy of a good file, and has to be rejected
+        //----------------------------------------------------
+        auto rejects = [&](const std::string& name, const std::function<void(ColumnFileHeader&)>& tamper)
+            {
+                std::string corrupt = bytes;
+                ColumnFileHeader header;
+                std::memcpy(&header, corrupt.data(), sizeof(header));
+                tamper(header);
+                std::memcpy(corrupt.data(), &header, sizeof(header));
+                bool rejected = false;
+                try
+                {
+                    const ColumnView view(corrupt);
+                }
+                catch (const std::runtime_error&)
+                {
+                    rejected = true;
+                }
+                check(encodingName + " rejects " + name, rejected);
+            };
+
+        rejects("more rows than the file holds", [](ColumnFileHeader& header) { header.rows *= 2; });
+        rejects("a column past the end of the file", [](ColumnFileHeader& header) { header.columns[1].offset += 1 << 20; });
+        if (encoding == ColumnEncoding::Raw)
+        {
+            // rows * 4 wraps around to 40
+            rejects("a row count that wraps the size check", [](ColumnFileHeader& header) { header.rows = (uint64_t(1) << 62) + 10; });
+        }
+        else
+        {
+            // (rows - 1) * 32 wraps around to 0
+            rejects("a row count that wraps the size check", [](ColumnFileHeader& header)
+                {
+                    header.rows = (uint64_t(1) << 59) + 1;
+                    header.columns[0].bitWidth = 32;
+                    header.columns[1].bitWidth = 32;
+                });
+            rejects("a huge row count with no bits per row", [](ColumnFileHeader& header)
+                {
+                    header.rows = uint64_t(1) << 40;
+                    header.columns[0].bitWidth = 0;
+                    header.columns[1].bitWidth = 0;
+                });
+            rejects("a bit width over 32", [](ColumnFileHeader& header) { header.columns[0].bitWidth = 33; });
+        }
+    }
+    std::filesystem::remove(filename);
+
+    if (failures > 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Every check passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+//********************************************************
+// Historian Hysteria, column file converter
+//
+// Author: Sahil Singh
+// Date: December 1 2024
+// https://adventofcode.com/2024/day/1
+//
+// Turns a Day 1 input into a binary column file (see
+// ColumnFile.h), so that analyses run over and over on
+// the same input don't have to parse the text each time.
+// Day1 reads either kind of file.
+//
+// Usage: Day1Convert <input file> <output file> [raw|packed]
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include "ColumnFile.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: Day1Convert <input file> <output file> [raw|packed]" << std::endl;
+        return 1;
+    }
+    const std::string input = argv[1];
+    const std::string output = argv[2];
+
+    // Raw columns can be used straight from the file, packed ones are smaller
+    ColumnEncoding encoding = ColumnEncoding::Raw;
+    if (argc > 3)
+    {
+        const std::string name = argv[3];
+        if (name == "packed") encoding = ColumnEncoding::DeltaPacked;
+        else if (name != "raw")
+        {
+            std::cerr << "Error: Unknown encoding " << name << ", use raw or packed" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        auto timeStart = std::chrono::high_resolution_clock::now();
+        std::vector<int> column1;
+        std::vector<int> column2;
+        readTwoColumns(input, column1, column2);
+        writeColumnFile(output, column1, column2, encoding);
+        auto timeEnd = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double, std::milli> time = timeEnd - timeStart;
+        std::cout << "Converted " << column1.size() << " rows in " << time.count() << " ms" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,65 +2,55 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <sstream>
 #include <algorithm>
-
-void readTwoColumns(const std::string& filename, std::vector<int>& column1, std::vector<int>& column2) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        int value1, value2;
-
-        if (iss >> value1 >> value2) {
-            column1.push_back(value1);
-            column2.push_back(value2);
-        }
-        else {
-            throw std::runtime_error("Invalid line format: " + line);
-        }
-    }
-    file.close();
-}
-
-int main(void)
+#include "ColumnFile.h"
+#include "Similarity.h"
+#include "RadixSort.h"
+#include "SumAbsDiff.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Allocations.h"
+
+int main(int argc, char* argv[])
 {
 	//const std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day1\\example.txt";
 	//const std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day1\\example2.txt";
-	const std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day1\\myinput.txt";
+	std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day1\\myinput.txt";
+
+    // The input can be given on the command line instead, as text or as a binary column file
+    // made by Day1Convert, which loads much faster (see ColumnFile.h)
+    if (argc > 1) fileName = argv[1];
+    setThreadCountFromEnvironment();
+
     std::vector<int> v1 = {};
     std::vector<int> v2 = {};
-    readTwoColumns(fileName,v1,v2);
+    {
+        AOC_TRACE_SCOPE("load");
+        AOC_ALLOC_PHASE("load");
+        readTwoColumns(fileName,v1,v2);
+    }
 
     // Sort the vectors
-    std::sort(v1.begin(),v1.end());	
-    std::sort(v2.begin(),v2.end());
-
-    // Accumulate the differences
-    int sum = 0;
-    for( int i = 0; i < v1.size(); i++ )
+    // Both are radix sorted at the same time, in parallel (see RadixSort.h)
     {
-        sum += fabs(v1[i] - v2[i]);
+        AOC_TRACE_SCOPE("sort");
+        AOC_ALLOC_PHASE("sort");
+        radixSortColumns(v1,v2);
     }
 
+    // Accumulate the differences
+    // This is done in 64 bit integers, with vector instructions and across threads (see SumAbsDiff.h)
+    const uint64_t sum = [&] { AOC_TRACE_SCOPE("sum"); AOC_ALLOC_PHASE("sum"); return sumAbsDiff(v1, v2); }();
+
     std::cout << "Sum is: " << sum << std::endl;
 
     // Gather the similarity score
-    int score = 0;
-    for( int i = 0; i < v1.size(); i++ )
-    {
-        int count = 0;
-        for( int j = 0; j < v2.size(); j++ )
-        {
-            if (v1[i] == v2[j]) count++;
-        }
-        score += v1[i] * count;
-    }
+    // Both lists are already sorted, so this is linear (see Similarity.h)
+    const int64_t score = [&] { AOC_TRACE_SCOPE("similarity"); AOC_ALLOC_PHASE("similarity"); return similarityScore(v1, v2); }();
 
     std::cout << "Similarity score is: " << score << std::endl;
+
+    AOC_ALLOC_REPORT(std::cout);
+    AOC_TRACE_SAVE("Day1_trace.json");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+//********************************************************
+// Radix Sort
+//
+// A parallel LSD (least significant digit first) radix
+// sort for columns of ints.
+//
+// Each int is sorted one byte at a time, starting from
+// the lowest byte, with a stable counting sort for every
+// byte. The sign bit is flipped on the way in so that
+// negative numbers come before positive ones.
+//
+// Each pass is done in parallel. The column is split into
+// blocks, and every block counts how many of its numbers
+// have each byte value. Laying those counts out byte
+// value first, block second, and taking the running total
+// of them (a prefix sum, done with parallelScan, see
+// Parallel.h) gives every block the exact spot where each of its
+// numbers has to go. Every block can then scatter its
+// numbers into place without touching any other block's.
+//
+// A pass is skipped entirely when every number has the
+// same byte in that position, which is very common for
+// the high bytes of small numbers. Small columns are
+// just handed to std::sort.
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Parallel.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+// Columns smaller than this are sorted with std::sort
+constexpr size_t radixSortMinimum = size_t(1) << 16;
+
+// The sort key for an int, with the sign bit flipped so that the keys sort as unsigned
+inline uint32_t radixKey(int value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+
+// Sort a column of ints, using scratch as working space
+// scratch is resized to the size of the column, and can be reused between calls.
+inline void radixSort(std::span<int> column, std::vector<int>& scratch)
+{
+    const size_t n = column.size();
+    if (n < radixSortMinimum)
+    {
+        std::sort(column.begin(), column.end());
+        return;
+    }
+
+    // Split the column into blocks, enough for every thread to have a few to work on
+    constexpr size_t buckets = 256;
+    const size_t maxBlocks = 4 * static_cast<size_t>(threadCount());
+    const size_t blocks = std::clamp<size_t>(n / radixSortMinimum, 1, maxBlocks);
+    const size_t blockSize = (n + blocks - 1) / blocks;
+
+    // counts[bucket * blocks + block] is how many numbers in a block have that byte value
+    // After the prefix sum, it's where the first of those numbers goes instead.
+    std::vector<size_t> counts(buckets * blocks);
+
+    scratch.resize(n);
+    int* from = column.data();
+    int* to = scratch.data();
+
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        AOC_TRACE_SCOPE("radix pass", shift / 8);
+
+        // Count the byte values in every block
+        parallelFor(0, blocks, 1, [&](size_t firstBlock, size_t lastBlock)
+            {
+                for (size_t block = firstBlock; block < lastBlock; block++)
+                {
+                    size_t local[buckets] = {};
+                    const size_t first = block * blockSize;
+                    const size_t last = std::min(n, first + blockSize);
+                    for (size_t i = first; i < last; i++)
+                    {
+                        local[(radixKey(from[i]) >> shift) & 0xFF]++;
+                    }
+                    for (size_t bucket = 0; bucket < buckets; bucket++)
+                    {
+                        counts[bucket * blocks + block] = local[bucket];
+                    }
+                }
+            });
+
+        // If every number has the same byte value here, this pass wouldn't move anything
+        const size_t firstBucket = (radixKey(from[0]) >> shift) & 0xFF;
+        size_t sameBucket = 0;
+        for (size_t block = 0; block < blocks; block++) sameBucket += counts[firstBucket * blocks + block];
+        if (sameBucket == n) continue;
+
+        // Turn the counts into starting positions
+        parallelScan(0, counts.size(), buckets, size_t(0),
+            [&](size_t first, size_t last, size_t sum, bool isFinalScan)
+            {
+                for (size_t i = first; i != last; i++)
+                {
+                    const size_t count = counts[i];
+                    if (isFinalScan) counts[i] = sum;
+                    sum += count;
+                }
+                return sum;
+            },
+            [](size_t left, size_t right) { return left + right; });
+
+        // Scatter every block's numbers into place
+        parallelFor(0, blocks, 1, [&](size_t firstBlock, size_t lastBlock)
+            {
+                for (size_t block = firstBlock; block < lastBlock; block++)
+                {
+                    size_t next[buckets];
+                    for (size_t bucket = 0; bucket < buckets; bucket++)
+                    {
+                        next[bucket] = counts[bucket * blocks + block];
+                    }
+                    const size_t first = block * blockSize;
+                    const size_t last = std::min(n, first + blockSize);
+                    for (size_t i = first; i < last; i++)
+                    {
+                        to[next[(radixKey(from[i]) >> shift) & 0xFF]++] = from[i];
+                    }
+                }
+            });
+
+        std::swap(from, to);
+    }
+
+    // After an odd number of passes the sorted numbers are in scratch, so copy them back
+    if (from != column.data())
+    {
+        parallelFor(0, n, radixSortMinimum, [&](size_t first, size_t last)
+            {
+                std::copy(from + first, from + last, column.data() + first);
+            });
+    }
+}
+
+// Sort a column of ints
+inline void radixSort(std::span<int> column)
+{
+    std::vector<int> scratch;
+    radixSort(column, scratch);
+}
+
+// Sort both columns at the same time
+// Each one gets its own sort running in parallel with the other, and the backend shares the
+// threads between the blocks of both.
+inline void radixSortColumns(std::vector<int>& column1, std::vector<int>& column2)
+{
+    parallelInvoke(
+        [&] { radixSort(column1); },
+        [&] { radixSort(column2); });
+}
@@ -0,0 +1,95 @@
+//********************************************************
+// Similarity
+//
+// Works out the similarity score of the two lists: every
+// number in the left list, multiplied by how many times
+// it appears in the right list, all added up.
+//
+// There are two ways of doing this, and both are linear:
+// - Merge: with both lists sorted, walk them together.
+//   Equal numbers sit in runs, so each matching pair of
+//   runs adds value * (left run) * (right run).
+// - Histogram: count how many times each number appears
+//   in the right list, in an array indexed by the number
+//   itself, then look every left number up in that.
+//
+// The histogram is quicker when the numbers are packed
+// into a small range, but needs an array as big as the
+// range, so the merge is used for anything else.
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Which way to work out the similarity score
+enum class SimilarityMethod { Auto, Merge, Histogram };
+
+// The biggest range of numbers the histogram is used for automatically
+// Past this, or past a few entries per number in the lists, the merge wins.
+constexpr int64_t maxHistogramRange = int64_t(1) << 22;
+
+// Similarity score of two sorted lists, by walking them together
+inline int64_t similarityMerge(std::span<const int> left, std::span<const int> right)
+{
+    int64_t score = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < left.size() && j < right.size())
+    {
+        if (left[i] < right[j]) i++;
+        else if (right[j] < left[i]) j++;
+        else
+        {
+            // Measure the run of this number in both lists
+            const int value = left[i];
+            const size_t leftStart = i;
+            const size_t rightStart = j;
+            while (i < left.size() && left[i] == value) i++;
+            while (j < right.size() && right[j] == value) j++;
+            score += int64_t(value) * int64_t(i - leftStart) * int64_t(j - rightStart);
+        }
+    }
+    return score;
+}
+
+// Similarity score of two lists by counting the right list into a histogram
+// The lists don't need to be sorted, and every number must be in [low, high].
+inline int64_t similarityHistogram(std::span<const int> left, std::span<const int> right, int low, int high)
+{
+    std::vector<uint32_t> counts(static_cast<size_t>(int64_t(high) - low + 1), 0);
+    for (const int value : right)
+    {
+        counts[static_cast<size_t>(int64_t(value) - low)]++;
+    }
+
+    int64_t score = 0;
+    for (const int value : left)
+    {
+        score += int64_t(value) * counts[static_cast<size_t>(int64_t(value) - low)];
+    }
+    return score;
+}
+
+// Similarity score of two sorted lists, picking whichever method suits the numbers in them
+inline int64_t similarityScore(std::span<const int> left, std::span<const int> right, SimilarityMethod method = SimilarityMethod::Auto)
+{
+    if (left.empty() || right.empty()) return 0;
+
+    // The lists are sorted, so the range of numbers is just the two ends
+    const int low = std::min(left.front(), right.front());
+    const int high = std::max(left.back(), right.back());
+    const int64_t range = int64_t(high) - low + 1;
+
+    if (method == SimilarityMethod::Auto)
+    {
+        const bool smallRange = range <= maxHistogramRange && range <= 4 * int64_t(left.size() + right.size());
+        method = smallRange ? SimilarityMethod::Histogram : SimilarityMethod::Merge;
+    }
+
+    if (method == SimilarityMethod::Histogram) return similarityHistogram(left, right, low, high);
+    return similarityMerge(left, right);
+}
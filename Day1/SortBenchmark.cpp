@@ -0,0 +1,93 @@
+//********************************************************
+// Historian Hysteria, sort benchmark
+//
+// Author: Sahil Singh
+// Date: December 1 2024
+// https://adventofcode.com/2024/day/1
+//
+// Nearly all of the time for a big Day 1 input goes into
+// sorting the two columns. This times the radix sort
+// (see RadixSort.h) against std::sort, and against the
+// parallel std::sort, on two columns of random numbers,
+// and checks that they all agree.
+//
+// Usage: Day1SortBenchmark [rows] [repeats]
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include "RadixSort.h"
+
+int main(int argc, char* argv[])
+{
+    // How big, and how many times?
+    const size_t rows = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    const int repeats = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    // Let's make two columns of numbers that look like the real input, 5 digits each
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<int> digits(10000, 99999);
+    std::vector<int> input1(rows);
+    std::vector<int> input2(rows);
+    for (size_t i = 0; i < rows; i++)
+    {
+        input1[i] = digits(random);
+        input2[i] = digits(random);
+    }
+
+    // What every sort should end up with
+    std::vector<int> expected1 = input1;
+    std::vector<int> expected2 = input2;
+    std::sort(expected1.begin(), expected1.end());
+    std::sort(expected2.begin(), expected2.end());
+
+    // Time a way of sorting both columns, keeping the best of the repeats
+    // Returns false if it didn't sort them properly
+    auto benchmark = [&](const std::string& label, const std::function<void(std::vector<int>&, std::vector<int>&)>& sortColumns)
+        {
+            double best = 0.0;
+            bool correct = true;
+            for (int repeat = 0; repeat < repeats; repeat++)
+            {
+                std::vector<int> column1 = input1;
+                std::vector<int> column2 = input2;
+
+                auto timeStart = std::chrono::high_resolution_clock::now();
+                sortColumns(column1, column2);
+                auto timeEnd = std::chrono::high_resolution_clock::now();
+
+                std::chrono::duration<double, std::milli> time = timeEnd - timeStart;
+                if (repeat == 0 || time.count() < best) best = time.count();
+                correct = correct && column1 == expected1 && column2 == expected2;
+            }
+
+            std::cout << "[" << label << "] " << best << " ms (" << rows / (best / 1000.0) / 1e6 << " million rows per second)";
+            std::cout << (correct ? "" : " WRONG") << std::endl;
+            return correct;
+        };
+
+    std::cout << "Sorting two columns of " << rows << " rows, best of " << repeats << std::endl;
+    bool correct = true;
+    correct &= benchmark("std::sort", [](std::vector<int>& column1, std::vector<int>& column2)
+        {
+            std::sort(column1.begin(), column1.end());
+            std::sort(column2.begin(), column2.end());
+        });
+    correct &= benchmark("std::sort par", [](std::vector<int>& column1, std::vector<int>& column2)
+        {
+            std::sort(std::execution::par, column1.begin(), column1.end());
+            std::sort(std::execution::par, column2.begin(), column2.end());
+        });
+    correct &= benchmark("radix", [](std::vector<int>& column1, std::vector<int>& column2)
+        {
+            radixSortColumns(column1, column2);
+        });
+
+    return correct ? 0 : 1;
+}
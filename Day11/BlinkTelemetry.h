@@ -0,0 +1,119 @@
+//********************************************************
+// Blink Telemetry
+//
+// Per blink statistics for the stone engine, so we can
+// see how the state space grows and when it saturates.
+//
+// The engine is templated on a telemetry type. The
+// default, NoTelemetry, does nothing at all and the
+// engine skips gathering any statistics for it at
+// compile time, so it costs nothing when disabled.
+// BlinkTelemetry records every blink, and can export
+// the records as CSV or JSON.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Everything we know about a single blink
+struct BlinkStats
+{
+    int blink;                  // Which blink this was, starting at 1
+    size_t liveStones;          // Distinct stones with a non-zero count going into the blink
+    size_t newRules;            // Stones that were added to the rule lookup table
+    size_t tableSize;           // Size of the rule lookup table after the blink
+    double loadFactor;          // Load factor of the rule lookup table
+    double meanProbeLength;     // Average number of entries compared to find a stone in the table
+    size_t maxProbeLength;      // Worst case number of entries compared to find a stone in the table
+    int64_t nanoseconds;        // Time taken by the blink itself
+};
+
+// Work out the probe lengths of a chained hash map
+// Finding the k-th entry of a bucket compares k entries, so a bucket with n entries
+// costs 1 + 2 + ... + n comparisons to find each of its entries once.
+template <typename Map>
+void probeLengths(const Map& map, double& mean, size_t& max)
+{
+    size_t total = 0;
+    max = 0;
+    for (size_t b = 0; b < map.bucket_count(); b++)
+    {
+        const size_t n = map.bucket_size(b);
+        total += n * (n + 1) / 2;
+        if (n > max) max = n;
+    }
+    mean = map.empty() ? 0.0 : static_cast<double>(total) / map.size();
+}
+
+// Telemetry that is compiled out entirely
+struct NoTelemetry
+{
+    static constexpr bool enabled = false;
+    void record(const BlinkStats&) {};
+};
+
+// Telemetry that keeps every blink's statistics
+class BlinkTelemetry
+{
+public:
+    static constexpr bool enabled = true;
+
+    void record(const BlinkStats& stats) { stats_.push_back(stats); };
+
+    // Getter
+    const std::vector<BlinkStats>& stats() const { return stats_; };
+
+    // Write the statistics out as CSV, one row per blink
+    void writeCsv(std::ostream& out) const
+    {
+        out << "blink,live_stones,new_rules,table_size,load_factor,mean_probe_length,max_probe_length,nanoseconds\n";
+        for (const auto& s : stats_)
+        {
+            out << s.blink << ',' << s.liveStones << ',' << s.newRules << ',' << s.tableSize << ','
+                << s.loadFactor << ',' << s.meanProbeLength << ',' << s.maxProbeLength << ',' << s.nanoseconds << '\n';
+        }
+    };
+
+    // Write the statistics out as a JSON array, one object per blink
+    void writeJson(std::ostream& out) const
+    {
+        out << "[\n";
+        for (size_t i = 0; i < stats_.size(); i++)
+        {
+            const auto& s = stats_[i];
+            out << "  {\"blink\": " << s.blink
+                << ", \"live_stones\": " << s.liveStones
+                << ", \"new_rules\": " << s.newRules
+                << ", \"table_size\": " << s.tableSize
+                << ", \"load_factor\": " << s.loadFactor
+                << ", \"mean_probe_length\": " << s.meanProbeLength
+                << ", \"max_probe_length\": " << s.maxProbeLength
+                << ", \"nanoseconds\": " << s.nanoseconds << "}"
+                << (i + 1 < stats_.size() ? ",\n" : "\n");
+        }
+        out << "]\n";
+    };
+
+    // Save the statistics to a file, picking the format from the file extension
+    // Anything that isn't .json is written as CSV
+    bool save(const std::string& filename) const
+    {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        const bool isJson = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+        if (isJson) writeJson(file);
+        else writeCsv(file);
+        return true;
+    };
+
+private:
+    std::vector<BlinkStats> stats_;
+};
@@ -10,222 +10,132 @@
 // each unique stone as well as how many of them there
 // are. I will also be generating a lookup table that
 // contains the results of applying the rules in order
-// to speedup computation.
+// to speedup computation. The engine that does all of
+// this lives in StoneEngine.h.
+//
+// The rules themselves are read from a rules file (see
+// StoneRules.h). The build compiles the rules file into
+// a specialized evaluator, and the same file is also
+// loaded at runtime and interpreted, so that we can see
+// how the two compare against each other.
+//
+// Setting DAY11_TELEMETRY_FILE when configuring the build
+// records statistics for every blink, and saves them to
+// that file as CSV (or JSON for a .json file).
 //********************************************************
 
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <sstream>
 #include <string>
-#include <chrono>
-#include <tbb\tbb.h>
+#include <filesystem>
+#include "MappedFile.h"
+#include "FastParse.h"
+#include "ScopedTimer.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Allocations.h"
+#include "StoneRules.h"
+#include "StoneEngine.h"
+#include "BuildRules.h"
 
 // Forward declarations
 std::vector<int64_t> readNumbersFromFile(const std::string& filename);
-bool hasEvenDigits(int64_t s);
-std::pair<int64_t, int64_t> splitDigits(const int64_t & s);
+
+// The per blink telemetry is compiled out unless we have somewhere to save it
+#ifdef DAY11_TELEMETRY_FILE
+using Telemetry = BlinkTelemetry;
+#else
+using Telemetry = NoTelemetry;
+#endif
 
 int main(void)
 {
 	// Let's read the input
     //std::string input = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day11\\smallexample.txt";
     std::string input = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day11\\myinput.txt";
-    std::vector<int64_t> stones = readNumbersFromFile(input);
+    std::vector<int64_t> stones = [&] { AOC_TRACE_SCOPE("load"); AOC_ALLOC_PHASE("load"); return readNumbersFromFile(input); }();
+    setThreadCountFromEnvironment();
 
     // How many blinks?
     const int N = 75;
 
-    // Every time the rules are applied to a stone, it can either remain a single stone, or split
-    // into two. This state will track the next evolution of a given stone, where stone2 will be
-    // set to -1 if the next evolution does not split.
-    struct EvolvedState
-    {
-        int64_t stone1;
-        int64_t stone2;
-    };
-
-    // Let's keep track of how many of each stone we currently have
-    // The map will be ordered as <stone, count> pairs with the stone value being the key
-    // This is our aggregate state, as we do not track the individual stones, but rather the
-    // total count of each unique number
-    std::unordered_map<int64_t, int64_t> stoneCount;
-
-    // Let's keep track of what a particular stone will turn into once the rules are applied
-    // The map will be ordered as <stone, evolved state> with the stone value being the key
-    std::unordered_map<int64_t, EvolvedState> ruleLookupTable;
-
-    // Search the current aggregate state for a stone, and see if it is present
-    auto stoneExists = [&](const int64_t& n) {return stoneCount.find(n) != stoneCount.end(); };
-
-    // Apply the problem's rules, and return an EvolvedState object containing the results of
-    // the evolution
-    auto applyRules = [&](const int64_t& s) 
+    // Let's run the full blinking process with a given set of rules
+    // Both the compiled and the interpreted rules go through the same engine, so any
+    // difference in timing comes down to how the rules are evaluated
+    auto blinkAll = [&](auto rules, const std::string& label)
         {
-            if (s == 0)
-            {
-                const int64_t nextStone = 1;
-                return EvolvedState{nextStone,-1};
-            }
-            else if (hasEvenDigits(s))
-            {
-                const auto splitPair = splitDigits(s);
-                return EvolvedState{splitPair.first,splitPair.second};
-            }
-            else
-            {
-                return EvolvedState{2024*s, -1};
-            }
-        };
+            // Timing for information
+            ScopedTimer timer;
 
-    // Let's add a stone to our aggregate state
-    // Since we are working with total counts and not individual stones, we need to also
-    // be able to add multiple stones. For example, a 0 will turn into a 1. If I have 5000
-    // stones that are marked 0, they will all turn into 1, and I need to be able to add 5000
-    // 1's to my aggregate state
-    auto addToState = [&](const int64_t& n, const int64_t count)
-        {
-            // Does this state not exist already?
-            // If it doesn't, let's create a new state, and calculate the action of the rules
-            if (!stoneExists(n)) 
-            {
-                stoneCount.insert({ n,count });
-                ruleLookupTable.insert({n, applyRules(n)});
-            }
-            else
+            // Let's initialize the aggregate state from the initial state vector we read in from file
+            StoneEngine<decltype(rules), Telemetry> engine(std::move(rules));
+            for (const auto& v : stones)
             {
-                stoneCount[n] += count;;
+                engine.add(v, 1);
             }
-        };
 
-    // Let's remove a stone from our aggregate state
-    // Similar to the adding function, we need to be able to remove multiple stones from the
-    // aggregate state.
-    auto removeFromState = [&](const int64_t& n, const int64_t count)
-        {
-            // If we're at 0 and trying to remove, something has gone wonky
-            // But, let's not do it, because we don't want to recompute the
-            // lookup table again. let's just leave it at 0
-            if( stoneExists(n) && stoneCount[n] > 0)
+            // Blinking loop
+            for (int i = 0; i < N; i++)
             {
-                stoneCount[n] -= count;
+                engine.blink();
             }
-        };
-    
-    // Timing for information
-    auto timeStart = std::chrono::high_resolution_clock::now();
 
-    // Let's initialize the aggregate state from the initial state vector we read in from file
-    for( const auto & v : stones )
-    {
-        addToState(v, 1);
-    }
-    
-    // Blinking loop
-    for (int i = 0; i < N; i++)
-    {
-        // Let's look at each entry in our current aggregate state
-        // We create a copy of the current aggregate state, so we have a static
-        // reference to loop over.
-        // This is important to do, as looping over the original map will not work, as that map
-        // will be changing and being updated, and we maye erroneously apply rules to newly
-        // added stones, thus giving us the incorrect answer.
-        const auto map = stoneCount;
-        for( const auto & entry : map )
-        {
-            // Calculate the evolved state and add it only if the current number actually has
-            // stones present. In order to maintain the lookup table, we keep stone entries in
-            // the aggregate state even if its count is 0, but we clearly do not want to iterate
-            // on 0 count stones.
-            if (entry.second > 0)
-            {
-                // Let's remove the starting stone from the state, as it is evolving
-                removeFromState(entry.first, entry.second);
-
-                // Let's evolve this entry
-                // When adding a new stone into the aggregate state, the rule lookup table
-                // is automatically updated, so every stone that exists or has ever existed in
-                // the state has a rule that has already been computed at this point
-                EvolvedState eS = ruleLookupTable[entry.first];
-
-                // There will always be a first stone, so let's add it to the state
-                addToState(eS.stone1, entry.second);
-
-                // If the second stone is valid, then add it to the state as well
-                if (eS.stone2 >= 0)
-                {
-                    addToState(eS.stone2, entry.second);
-                }
-            }
-        }
-    }
-
-    // Let's retrieve our total count and print it out
-    int64_t count = 0;
-    for( const auto & entry : stoneCount )
-    {
-        count += entry.second;
-    }
+            // Let's retrieve our total count
+            const int64_t count = engine.count();
 
-    // Finish our timing
-    auto timeEnd = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> elapsed = timeEnd - timeStart;
+            // Finish our timing
+            const double elapsed = timer.elapsed();
 
-    // Print end results
-    std::cout << "After " << N << " blinks, we have " << count << " stones." << std::endl;
-    std::cout << "The lookup table ended up having " << ruleLookupTable.size() << " entries." << std::endl;
-    std::cout << "Elapsed time: " << elapsed.count() << " ms" << std::endl;
+            // Print end results
+            std::cout << "[" << label << "] After " << N << " blinks, we have " << count << " stones." << std::endl;
+            std::cout << "[" << label << "] The lookup table ended up having " << engine.tableSize() << " entries." << std::endl;
+            std::cout << "[" << label << "] Elapsed time: " << elapsed << " ms" << std::endl;
 
-	return 0;
-}
+#ifdef DAY11_TELEMETRY_FILE
+            // Each run gets its own telemetry file, tagged with the run's label
+            std::filesystem::path telemetryFile = DAY11_TELEMETRY_FILE;
+            telemetryFile.replace_filename(telemetryFile.stem().string() + "_" + label + telemetryFile.extension().string());
+            if (!engine.telemetry().save(telemetryFile.string()))
+            {
+                std::cerr << "Error: Could not write telemetry to " << telemetryFile << std::endl;
+            }
+#endif
+            return count;
+        };
 
-// Function to tell if a given number has an even number of digits or not
-// The parameter copies the input value, so that we are free to modify it
-// and divide it by 10 repeatedly to count digits
-bool hasEvenDigits(int64_t n)
-{
-    int digitCount = 0;
-    while (n > 0) {
-        n /= 10;
-        digitCount++;
-    }
-    return (digitCount & 1) == 0; // Faster check for even numbers
-}
+    // The rules that were compiled into this build
+    const int64_t compiledCount = [&] { AOC_ALLOC_PHASE("compiled"); return blinkAll(BuildRules{}, "compiled"); }();
 
-// Function to take our input digit and split it into two halves
-std::pair<int64_t, int64_t> splitDigits(const int64_t& s)
-{
-    int digitCount = 0;
-    int64_t temp = s;
-    while (temp > 0) {
-        temp /= 10;
-        digitCount++;
-    }
+    // The same rules, read in from file and interpreted
+    const int64_t interpretedCount = [&] { AOC_ALLOC_PHASE("interpreted"); return blinkAll(RuleSet::load(DAY11_RULES_FILE), "interpreted"); }();
 
-    int64_t divisor = 1;
-    for (int i = 0; i < digitCount / 2; ++i) {
-        divisor *= 10;
+    // These should always agree, if they don't, one of the evaluators is broken
+    if (compiledCount != interpretedCount)
+    {
+        std::cerr << "Error: The compiled and interpreted rules disagree" << std::endl;
+        return 1;
     }
 
-    return { s / divisor, s % divisor };
+    AOC_ALLOC_REPORT(std::cout);
+    AOC_TRACE_SAVE("Day11_trace.json");
+	return 0;
 }
 
 // Function to read a filename into a std::vector
 // This will read our input
 std::vector<int64_t> readNumbersFromFile(const std::string& filename) {
     std::vector<int64_t> numbers;
-    std::ifstream inputFile(filename);
+    MappedFile inputFile(filename);
 
-    if (!inputFile.is_open()) {
+    if (!inputFile.isOpen()) {
         std::cerr << "Error: Could not open file " << filename << std::endl;
         return numbers;
     }
 
-    std::string line;
-    if (std::getline(inputFile, line)) {
-        std::stringstream ss(line);
+    if (inputFile.size() > 0) {
+        IntegerScanner scanner(inputFile.view());
         int64_t number;
-        while (ss >> number) {
+        while (scanner.next(number)) {
             numbers.push_back(number);
         }
     }
@@ -233,6 +143,5 @@ std::vector<int64_t> readNumbersFromFile(const std::string& filename) {
         std::cerr << "Error: Failed to read data from the file" << std::endl;
     }
 
-    inputFile.close();
     return numbers;
-}
\ No newline at end of file
+}
@@ -0,0 +1,169 @@
+//********************************************************
+// Plutonian Pebbles Problem, batch mode
+//
+// Author: Sahil Singh
+// Date: December 11 2024
+// https://adventofcode.com/2024/day/11
+//
+// The regular solver handles one line of stones per run.
+// This one reads a file with any number of lines of
+// stones, runs all of them through one shared rule
+// lookup table and memo (see StoneBatch.h), and prints
+// the total number of stones for each line, one per line.
+// A line whose total doesn't fit in 64 bits gets an error
+// instead, and makes the run fail.
+//
+// Usage: Day11Batch [input file] [blinks]
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <cstdint>
+#include "MappedFile.h"
+#include "FastParse.h"
+#include "ScopedTimer.h"
+#include "ThreadPool.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "Allocations.h"
+#include "StoneRules.h"
+#include "StoneBatch.h"
+#include "BuildRules.h"
+
+// The most blinks a run can ask for
+// The totals overflow long before this, it's just so that a typo can't run for ever
+constexpr int maxBatchBlinks = 1000;
+
+// Forward declarations
+bool readLinesFromFile(const std::string& filename, std::vector<int64_t>& stones, std::vector<size_t>& lineStarts);
+
+int main(int argc, char* argv[])
+{
+    // Let's read the input
+    std::string input = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day11\\batchinput.txt";
+    if (argc > 1) input = argv[1];
+
+    // How many blinks?
+    int N = 75;
+    if (argc > 2)
+    {
+        const std::string blinks = argv[2];
+        const auto parsed = std::from_chars(blinks.data(), blinks.data() + blinks.size(), N);
+        if (parsed.ec != std::errc() || parsed.ptr != blinks.data() + blinks.size() || N < 0 || N > maxBatchBlinks)
+        {
+            std::cerr << "Error: The number of blinks must be between 0 and " << maxBatchBlinks << std::endl;
+            return 1;
+        }
+    }
+
+    // The number of threads can be limited with AOC_THREADS
+    setThreadCountFromEnvironment();
+
+    // Timing for information
+    ScopedTimer timer;
+
+    // All of the stones from every line live in one array, and line i's stones are the range
+    // [lineStarts[i], lineStarts[i + 1])
+    std::vector<int64_t> stones;
+    std::vector<size_t> lineStarts;
+    {
+        AOC_TRACE_SCOPE("load");
+        AOC_ALLOC_PHASE("load");
+        if (!readLinesFromFile(input, stones, lineStarts))
+        {
+            return 1;
+        }
+    }
+    const size_t lineCount = lineStarts.size() - 1;
+    const double readTime = timer.elapsed();
+    timer.restart();
+
+    // Let's solve every line
+    // The batch is shared by every thread, so the rules and totals worked out for one line
+    // are there for every other line to use.
+    StoneBatch batch(BuildRules{}, N);
+    std::vector<int64_t> totals(lineCount);
+    std::vector<uint8_t> overflowed(lineCount, 0);
+    {
+        AOC_ALLOC_PHASE("solve");
+        parallelFor(0, lineCount, 64, [&](size_t first, size_t last)
+            {
+                AOC_TRACE_SCOPE("solve lines", static_cast<int64_t>(last - first));
+                for (size_t i = first; i != last; i++)
+                {
+                    overflowed[i] = !batch.checkedCount(stones.data() + lineStarts[i], stones.data() + lineStarts[i + 1], totals[i]);
+                }
+            });
+    }
+
+    // Finish our timing
+    const double solveTime = timer.elapsed();
+
+    // Print one total per line
+    // Build the whole output up front, writing millions of lines one at a time is slow
+    std::string output;
+    output.reserve(lineCount * 16);
+    char buffer[24];
+    size_t overflowCount = 0;
+    for (size_t i = 0; i < lineCount; i++)
+    {
+        if (overflowed[i])
+        {
+            output += "error: count overflows\n";
+            overflowCount++;
+            continue;
+        }
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), totals[i]);
+        output.append(buffer, result.ptr);
+        output.push_back('\n');
+    }
+    std::cout << output;
+
+    // The summary goes to stderr, so that stdout only has the totals in it
+    std::cerr << "Solved " << lineCount << " lines with " << N << " blinks each." << std::endl;
+    std::cerr << "The lookup table ended up having " << batch.tableSize() << " entries, and the memo " << batch.memoSize() << "." << std::endl;
+    std::cerr << "Read time: " << readTime << " ms" << std::endl;
+    std::cerr << "Solve time: " << solveTime << " ms (" << lineCount / (solveTime / 1000.0) << " lines per second)" << std::endl;
+
+    AOC_ALLOC_REPORT(std::cerr);
+    AOC_TRACE_SAVE("Day11Batch_trace.json");
+
+    if (overflowCount > 0)
+    {
+        std::cerr << "Error: " << overflowCount << " lines have more stones than fit in 64 bits" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Function to read every line of a file into one array of stones
+// Returns false if the file couldn't be read
+bool readLinesFromFile(const std::string& filename, std::vector<int64_t>& stones, std::vector<size_t>& lineStarts)
+{
+    MappedFile inputFile(filename);
+    if (!inputFile.isOpen()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    // Every line is a set of stones, and an empty file has no lines at all
+    lineStarts.push_back(0);
+    if (inputFile.size() == 0) return true;
+
+    IntegerScanner scanner(inputFile.view());
+    do {
+        int64_t number;
+        while (scanner.next(number)) {
+            stones.push_back(number);
+        }
+        if (scanner.failed()) {
+            std::cerr << "Error: Invalid stone on line " << scanner.line() << std::endl;
+            return false;
+        }
+        lineStarts.push_back(stones.size());
+    } while (scanner.nextLine());
+
+    return true;
+}
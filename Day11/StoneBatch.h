@@ -0,0 +1,200 @@
+//********************************************************
+// Stone Batch
+//
+// Solves many stone lines against one shared, warmed up
+// rule lookup table.
+//
+// The number of stones a line turns into is just the sum
+// of what each of its stones turns into on its own, and a
+// stone's total after n blinks is the sum of its evolved
+// stones' totals after n - 1 blinks. So rather than
+// running the aggregate state once per line, we memoize
+// the total for every (stone, blinks remaining) pair we
+// come across. After a few lines the memo is warm, and a
+// whole line costs one lookup per stone.
+//
+// Both the rule table and the memo are concurrent maps
+// (see Parallel.h), so any number of lines can be solved
+// at once.
+// Two threads may occasionally work out the same entry,
+// but they always get the same answer, so the totals are
+// deterministic.
+//
+// A stone's total is worked out with an explicit stack
+// rather than by recursing once per blink, so the number
+// of blinks isn't limited by the size of a thread's
+// stack. Every sum is checked (see Checked.h), and a
+// total that doesn't fit in 64 bits is remembered as
+// having overflowed, just like in the stone engine. So
+// is the total of a stone that evolves into one that
+// doesn't fit (see StoneRules.h).
+//********************************************************
+
+#pragma once
+
+#include "StoneRules.h"
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Checked.h"
+#include "Parallel.h"
+
+template <typename Rules>
+class StoneBatch
+{
+public:
+
+    // Constructor
+    // Every line handled by this batch gets the same number of blinks
+    StoneBatch(Rules rules, int blinks) : applyRules_(std::move(rules)), blinks_(blinks)
+    {
+        if (blinks < 0) {
+            throw std::runtime_error("The number of blinks can't be negative");
+        }
+    };
+
+    // How many stones does a single stone turn into after all of the blinks?
+    // Throws if it doesn't fit in 64 bits
+    int64_t count(int64_t stone) { return count(&stone, &stone + 1); };
+
+    // How many stones does a whole line of stones turn into after all of the blinks?
+    // Throws if it doesn't fit in 64 bits
+    int64_t count(const int64_t* first, const int64_t* last)
+    {
+        int64_t total = 0;
+        if (!checkedCount(first, last, total)) {
+            throw std::runtime_error("count overflows");
+        }
+        return total;
+    };
+
+    // How many stones does a whole line of stones turn into after all of the blinks, if that
+    // fits in 64 bits?
+    // Returns false if it doesn't.
+    bool checkedCount(const int64_t* first, const int64_t* last, int64_t& total)
+    {
+        total = 0;
+        for (; first != last; ++first)
+        {
+            if (!addTotal(total, count(*first, blinks_))) return false;
+        }
+        return true;
+    };
+
+    // Getters
+    int blinks() const { return blinks_; };
+    size_t tableSize() const { return ruleLookupTable_.size(); };
+    size_t memoSize() const { return memo_.size(); };
+
+private:
+
+    // Look up what a stone evolves into, applying the rules if we've never seen it before
+    EvolvedState evolve(int64_t s)
+    {
+        EvolvedState eS;
+        if (!ruleLookupTable_.find(s, eS))
+        {
+            eS = ruleLookupTable_.insert(s, applyRules_(s));
+        }
+        return eS;
+    };
+
+    // The total the memo keeps for a stone whose total doesn't fit in 64 bits
+    // A real total is never less than 1.
+    static constexpr int64_t overflowed = -1;
+
+    // Add a stone's total to a running total
+    // Returns false, and leaves the running total as overflowed, if either one has overflowed or
+    // the sum doesn't fit.
+    static bool addTotal(int64_t& total, int64_t stoneTotal)
+    {
+        if (total != overflowed && stoneTotal != overflowed && checkedAdd(total, stoneTotal)) return true;
+        total = overflowed;
+        return false;
+    };
+
+    // How many stones does a stone turn into with a given number of blinks remaining?
+    // Returns overflowed if that doesn't fit in 64 bits.
+    int64_t count(int64_t stone, int remaining)
+    {
+        // No blinks left, so it's just this stone
+        if (remaining == 0) return 1;
+
+        // Have we already worked this out?
+        int64_t total = 0;
+        if (memo_.find({ stone, remaining }, total)) return total;
+
+        // If not, it's the total of everything this stone evolves into
+        // Each frame on the stack is a stone whose total we're adding up, and its evolved stones
+        // are handled one at a time. One that isn't in the memo yet gets a frame of its own,
+        // and once all of a frame's stones are added up, its total goes in the memo and is
+        // added to the frame below. The evolved state is copied out of the table, as working
+        // out the other stones may insert into it. A stone that overflows has no evolved stones,
+        // and its total starts out as overflowed.
+        struct Frame
+        {
+            int64_t stone;
+            int remaining;
+            EvolvedState evolved;
+            int next;
+            int64_t total;
+        };
+        std::vector<Frame> stack;
+        auto push = [&](int64_t s, int r)
+            {
+                const EvolvedState evolved = evolve(s);
+                stack.push_back({ s, r, evolved, 0, evolved.overflowed ? overflowed : 0 });
+            };
+        push(stone, remaining);
+        while (true)
+        {
+            Frame& frame = stack.back();
+            if (frame.next == frame.evolved.count)
+            {
+                memo_.insert({ frame.stone, frame.remaining }, frame.total);
+                total = frame.total;
+                stack.pop_back();
+                if (stack.empty()) return total;
+                addTotal(stack.back().total, total);
+                continue;
+            }
+
+            const int64_t next = frame.evolved.stones[frame.next++];
+            int64_t nextTotal = 1;
+            if (frame.remaining > 1 && !memo_.find({ next, frame.remaining - 1 }, nextTotal))
+            {
+                // The new frame may move the stack, so frame isn't used after this
+                push(next, frame.remaining - 1);
+                continue;
+            }
+            addTotal(frame.total, nextTotal);
+        }
+    };
+
+    // The memo is keyed on the stone along with how many blinks it has left
+    using MemoKey = std::pair<int64_t, int>;
+    struct MemoKeyHash
+    {
+        size_t operator()(const MemoKey& key) const
+        {
+            // Spread the stone's bits out before mixing in the blinks, as neighbouring stones
+            // are very common
+            return std::hash<uint64_t>{}((static_cast<uint64_t>(key.first) * 0x9E3779B97F4A7C15ull) ^ key.second);
+        };
+    };
+
+    // The rules that evolve a stone
+    Rules applyRules_;
+
+    // How many blinks every line gets
+    int blinks_;
+
+    // Let's keep track of what a particular stone will turn into once the rules are applied
+    ConcurrentMap<int64_t, EvolvedState> ruleLookupTable_;
+
+    // The total number of stones for each (stone, blinks remaining) pair we've worked out
+    ConcurrentMap<MemoKey, int64_t, MemoKeyHash> memo_;
+};
@@ -0,0 +1,328 @@
+//********************************************************
+// Stone Engine
+//
+// The aggregated state engine for the Plutonian pebbles.
+// Rather than tracking every individual stone, we track
+// each unique stone along with how many of them there
+// are, and a lookup table that caches the result of
+// applying the rules to every stone we've ever seen.
+//
+// Every stone is interned the first time we see it,
+// which gives it a dense ID. The lookup table is then a
+// flat transition array from IDs to IDs, and the counts
+// are a flat array indexed by ID. The only hashing left
+// happens when a brand new stone shows up, so once the
+// state space saturates a blink is nothing more than a
+// linear gather over arrays.
+//
+// The engine is templated on the rules, so a rule set
+// that is known at compile time gets a fully specialized
+// engine, while a rule set read in at runtime goes
+// through the interpreter. See StoneRules.h.
+//
+// Each blink is done in parallel (see Parallel.h), split
+// up by the stone a count goes to rather than the one it
+// comes from. Alongside the transitions we keep their
+// inverse, the list of stones that turn into each stone,
+// so every stone's new count is gathered from its
+// sources, and no two threads ever write to the same
+// count. That needs no per thread copies of the counts,
+// so the work and memory of a blink stay proportional to
+// the number of transitions however many threads there
+// are. The inverse is rebuilt whenever new transitions
+// show up, which stops happening once the state space
+// saturates. Since we are only ever adding integer
+// counts, the totals are identical no matter how the work
+// was split up.
+//
+// The counts grow exponentially, and a few hundred
+// blinks are enough for them to stop fitting in 64 bits.
+// Every addition is checked (see Checked.h), and once
+// a count has overflowed the engine remembers it, so
+// the total is never silently wrong. A live stone that
+// evolves into one that doesn't fit in 64 bits (see
+// StoneRules.h) counts as an overflow too.
+//
+// The engine can also report statistics for every blink
+// through a telemetry type, see BlinkTelemetry.h.
+//********************************************************
+
+#pragma once
+
+#include "StoneRules.h"
+#include "BlinkTelemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Checked.h"
+#include "Parallel.h"
+#include "Trace.h"
+
+template <typename Rules, typename Telemetry = NoTelemetry>
+class StoneEngine
+{
+public:
+
+    // Constructor
+    // The engine starts out with no stones, and an empty lookup table
+    explicit StoneEngine(Rules rules, Telemetry telemetry = {}) : applyRules_(std::move(rules)), telemetry_(std::move(telemetry))
+    {
+        transitionStarts_.push_back(0);
+    };
+
+    // Let's add a stone to our aggregate state
+    // Since we are working with total counts and not individual stones, we need to also
+    // be able to add multiple stones. For example, a 0 will turn into a 1. If I have 5000
+    // stones that are marked 0, they will all turn into 1, and I need to be able to add 5000
+    // 1's to my aggregate state
+    void add(const int64_t& n, const int64_t count)
+    {
+        const uint32_t id = intern(n);
+        if (!checkedAdd(stoneCount_[id], count)) overflowed_ = true;
+    };
+
+    // Apply the rules to every stone in the aggregate state once
+    void blink()
+    {
+        AOC_TRACE_SCOPE("blink", blinks_ + 1);
+
+        // Only bother reading the clock if someone is listening
+        std::chrono::steady_clock::time_point blinkStart;
+        size_t liveStones = 0;
+        if constexpr (Telemetry::enabled)
+        {
+            blinkStart = std::chrono::steady_clock::now();
+            liveStones = distinctStones();
+        }
+
+        // Every stone we've interned so far could be alive, so make sure they all have their
+        // transitions worked out. This interns any stones they evolve into, which won't need
+        // transitions until the next blink.
+        const size_t newRules = [&] { AOC_TRACE_SCOPE("resolve"); return resolve(); }();
+        const size_t stoneTotal = stones_.size();
+
+        // Any new transitions have to be in the inverse before we can gather along it
+        if (newRules > 0 || sourceStarts_.size() != stoneTotal + 1)
+        {
+            AOC_TRACE_SCOPE("invert");
+            invert();
+        }
+
+        // A stone that overflowed has nowhere to send its count, so it only matters once it's alive
+        for (const uint32_t id : overflowingStones_)
+        {
+            if (stoneCount_[id] != 0) overflowed_ = true;
+        }
+
+        // Let's evolve every live stone
+        // Every stone's new count is the sum of the counts of the stones that turn into it, so
+        // each thread gathers the new counts for its own range of IDs. Reading the old counts and
+        // the inverse from every thread is safe, as nobody writes to them during this phase.
+        // The new counts go into an array that's kept around between blinks, so once the state
+        // space has saturated, a blink doesn't allocate anything.
+        // Each task only flags an overflow once it's done, so the sums themselves stay cheap.
+        nextCount_.resize(stoneTotal);
+        std::atomic<bool> overflowed = false;
+        parallelFor(0, stoneTotal, grainSize, [&](size_t first, size_t last)
+            {
+                bool sliceOverflowed = false;
+                for (size_t id = first; id != last; id++)
+                {
+                    int64_t n = 0;
+                    for (uint32_t s = sourceStarts_[id]; s < sourceStarts_[id + 1]; s++)
+                    {
+                        sliceOverflowed |= !checkedAdd(n, stoneCount_[sources_[s]]);
+                    }
+                    nextCount_[id] = n;
+                }
+                if (sliceOverflowed) overflowed = true;
+            });
+        std::swap(stoneCount_, nextCount_);
+        if (overflowed) overflowed_ = true;
+        blinks_++;
+
+        // Report how this blink went
+        // The probe lengths walk every bucket of the intern table, so this is only done when
+        // the telemetry is actually enabled
+        if constexpr (Telemetry::enabled)
+        {
+            const auto blinkEnd = std::chrono::steady_clock::now();
+            BlinkStats stats{};
+            stats.blink = blinks_;
+            stats.liveStones = liveStones;
+            stats.newRules = newRules;
+            stats.tableSize = stones_.size();
+            stats.loadFactor = ids_.load_factor();
+            probeLengths(ids_, stats.meanProbeLength, stats.maxProbeLength);
+            stats.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(blinkEnd - blinkStart).count();
+            telemetry_.record(stats);
+        }
+    };
+
+    // Total number of stones currently in the aggregate state
+    // Throws if it doesn't fit in 64 bits
+    int64_t count() const
+    {
+        int64_t count = 0;
+        if (!checkedCount(count)) {
+            throw std::runtime_error("count overflows");
+        }
+        return count;
+    };
+
+    // Total number of stones currently in the aggregate state, if it fits in 64 bits
+    // Returns false if it doesn't, or if the count of any one stone already didn't. Stones never
+    // disappear, so once this returns false it will for every blink after that too.
+    bool checkedCount(int64_t& count) const
+    {
+        count = 0;
+        if (overflowed_) return false;
+        for (const auto& n : stoneCount_)
+        {
+            if (!checkedAdd(count, n)) return false;
+        }
+        return true;
+    };
+
+    // Number of distinct stones currently alive
+    size_t distinctStones() const
+    {
+        size_t distinct = 0;
+        for (const auto& n : stoneCount_)
+        {
+            if (n != 0) distinct++;
+        }
+        return distinct;
+    };
+
+    // Getters
+    size_t tableSize() const { return stones_.size(); };
+    const Telemetry& telemetry() const { return telemetry_; };
+
+private:
+
+    // How many IDs each parallel task handles at minimum
+    // Small aggregate states are handled by a single task rather than being chopped up across
+    // every core, as handing out the tasks would cost more than the work in them.
+    static constexpr size_t grainSize = 4096;
+
+    // Look up the dense ID of a stone, handing out the next ID if we've never seen it before
+    uint32_t intern(int64_t n)
+    {
+        const auto [it, inserted] = ids_.insert({ n, static_cast<uint32_t>(stones_.size()) });
+        if (inserted)
+        {
+            stones_.push_back(n);
+            stoneCount_.push_back(0);
+        }
+        return it->second;
+    };
+
+    // Work out the transitions of every stone that doesn't have them yet
+    // Returns how many new transitions were added
+    size_t resolve()
+    {
+        // Applying the rules is the expensive part, so it's done in parallel for every new stone
+        // first, and interning the results afterwards is done in order, so that the IDs handed
+        // out never depend on how the work was split up.
+        const size_t first = transitionStarts_.size() - 1;
+        const size_t last = stones_.size();
+        std::vector<EvolvedState> newRules(last - first);
+        parallelFor(first, last, grainSize, [&](size_t firstId, size_t lastId)
+            {
+                for (size_t id = firstId; id != lastId; id++)
+                {
+                    newRules[id - first] = applyRules_(stones_[id]);
+                }
+            });
+
+        for (size_t i = 0; i < newRules.size(); i++)
+        {
+            const EvolvedState& eS = newRules[i];
+            if (eS.overflowed) overflowingStones_.push_back(static_cast<uint32_t>(first + i));
+            for (int s = 0; s < eS.count; s++)
+            {
+                transitions_.push_back(intern(eS.stones[s]));
+            }
+            transitionStarts_.push_back(static_cast<uint32_t>(transitions_.size()));
+        }
+
+        return newRules.size();
+    };
+
+    // Rebuild the inverse of the transitions, with a counting sort of every transition by the
+    // stone it goes to
+    // Within each stone's list, its sources end up in order of ID, so the gather walks through
+    // the counts in order.
+    void invert()
+    {
+        const size_t stoneTotal = stones_.size();
+        const size_t resolved = transitionStarts_.size() - 1;
+        sourceStarts_.assign(stoneTotal + 1, 0);
+        for (const uint32_t to : transitions_)
+        {
+            sourceStarts_[to + 1]++;
+        }
+        for (size_t id = 0; id < stoneTotal; id++)
+        {
+            sourceStarts_[id + 1] += sourceStarts_[id];
+        }
+
+        std::vector<uint32_t> next(sourceStarts_.begin(), sourceStarts_.end() - 1);
+        sources_.resize(transitions_.size());
+        for (size_t id = 0; id < resolved; id++)
+        {
+            for (uint32_t t = transitionStarts_[id]; t < transitionStarts_[id + 1]; t++)
+            {
+                sources_[next[transitions_[t]]++] = static_cast<uint32_t>(id);
+            }
+        }
+    };
+
+    // The rules that evolve a stone
+    Rules applyRules_;
+
+    // Where the per blink statistics go
+    [[no_unique_address]] Telemetry telemetry_;
+
+    // How many times we've blinked so far
+    int blinks_ = 0;
+
+    // The intern table, which hands out a dense ID for each unique stone
+    // This is the only place a stone's value is ever hashed
+    std::unordered_map<int64_t, uint32_t> ids_;
+
+    // The value of the stone behind each ID
+    std::vector<int64_t> stones_;
+
+    // Let's keep track of what a particular stone will turn into once the rules are applied
+    // This is a flat lookup table, where the stone with a given ID turns into the stones
+    // transitions_[transitionStarts_[id]] up to transitions_[transitionStarts_[id + 1]]
+    std::vector<uint32_t> transitionStarts_;
+    std::vector<uint32_t> transitions_;
+
+    // The inverse of the transitions, where the stones that turn into the stone with a given ID
+    // are sources_[sourceStarts_[id]] up to sources_[sourceStarts_[id + 1]]
+    // A stone that turns into two of the same stone is in that stone's list twice.
+    std::vector<uint32_t> sourceStarts_;
+    std::vector<uint32_t> sources_;
+
+    // The new counts for the blink in progress
+    std::vector<int64_t> nextCount_;
+
+    // The IDs of the stones that evolve into a stone that doesn't fit in 64 bits
+    std::vector<uint32_t> overflowingStones_;
+
+    // Has the count of any stone ever not fit in 64 bits, or has a live stone overflowed?
+    bool overflowed_ = false;
+
+    // Let's keep track of how many of each stone we currently have, indexed by ID
+    // This is our aggregate state, as we do not track the individual stones, but rather the
+    // total count of each unique number
+    std::vector<int64_t> stoneCount_;
+};
@@ -0,0 +1,247 @@
+//********************************************************
+// Stone Rules
+//
+// The rules that decide what a stone turns into when we
+// blink. A rule set is an ordered list of rules, and the
+// first rule that matches a stone decides its evolution.
+// If no rule matches, the stone stays as it is.
+//
+// Rule sets are written in a small text format, one rule
+// per line, with # starting a comment:
+//
+//     equals 0 -> 1      a stone marked 0 becomes a 1
+//     split 10 2         split stones whose base 10 digit
+//                        count divides by 2 into 2 parts
+//     multiply 2024      multiply the stone by 2024
+//
+// There are two ways of evaluating a rule set:
+//     - StaticRuleSet, where the rules are template
+//       parameters, so the compiler can specialize the
+//       whole evaluation (the build generates one of these
+//       from a rules file, see BuildRules.h.in)
+//     - RuleSet, which is loaded from a file at runtime and
+//       interprets the rules one at a time
+//
+// Both are callables that take a stone and return an
+// EvolvedState, so either can drive the same engine.
+//
+// Multiplying can take a stone past what fits in 64
+// bits. Rather than wrapping around (which is undefined
+// for signed integers), the multiply is checked (see
+// Checked.h), and the evolved state says it overflowed.
+// The engines then report it just like a count that
+// doesn't fit.
+//********************************************************
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Checked.h"
+
+// The most stones a single stone can evolve into in one blink
+constexpr int maxEvolvedStones = 4;
+
+// Every time the rules are applied to a stone, it can either remain a single stone, or split
+// into several. This state tracks the next evolution of a given stone, where only the first
+// count entries of stones are valid.
+// If the stone evolves into one that doesn't fit in 64 bits, overflowed is set and there are no
+// valid stones at all.
+struct EvolvedState
+{
+    std::array<int64_t, maxEvolvedStones> stones;
+    int count;
+    bool overflowed = false;
+};
+
+// The evolved state of a stone that evolves into one that doesn't fit in 64 bits
+constexpr EvolvedState overflowedState() { return EvolvedState{ {}, 0, true }; }
+
+// Count the number of digits a stone has in the given base
+// A stone marked 0 still has a single digit written on it
+constexpr int countDigits(int64_t s, int64_t base)
+{
+    int digitCount = 1;
+    while (s >= base) {
+        s /= base;
+        digitCount++;
+    }
+    return digitCount;
+}
+
+// Split a stone into equal width groups of digits, with the most significant group first
+// Any leading zeros in a group simply vanish, so 1000 split in two becomes 10 and 0.
+constexpr EvolvedState splitDigits(int64_t s, int64_t base, int parts, int digitCount)
+{
+    // The divisor that peels one group of digits off of the end of the stone
+    int64_t divisor = 1;
+    for (int i = 0; i < digitCount / parts; ++i) {
+        divisor *= base;
+    }
+
+    // Peel the groups off from least significant to most significant
+    EvolvedState out{ {}, parts };
+    for (int i = parts - 1; i >= 0; --i) {
+        out.stones[i] = s % divisor;
+        s /= divisor;
+    }
+    return out;
+}
+
+//-------------------------------------------------------------------
+// Compile time rules
+// Each rule has an apply function that fills in the evolved state
+// and returns true if the rule matched the stone.
+//-------------------------------------------------------------------
+template <int64_t Value, int64_t Replacement>
+struct Equals
+{
+    static constexpr bool apply(int64_t s, EvolvedState& out)
+    {
+        if (s != Value) return false;
+        out = EvolvedState{ {Replacement}, 1 };
+        return true;
+    }
+};
+
+template <int64_t Base, int Parts>
+struct Split
+{
+    static_assert(Base >= 2, "Stones must be split in a base of at least 2");
+    static_assert(Parts >= 2 && Parts <= maxEvolvedStones, "Unsupported number of split parts");
+
+    static constexpr bool apply(int64_t s, EvolvedState& out)
+    {
+        const int digitCount = countDigits(s, Base);
+        if (digitCount % Parts != 0) return false;
+        out = splitDigits(s, Base, Parts, digitCount);
+        return true;
+    }
+};
+
+template <int64_t Multiplier>
+struct Multiply
+{
+    static constexpr bool apply(int64_t s, EvolvedState& out)
+    {
+        out = checkedMultiply(s, Multiplier) ? EvolvedState{ {s}, 1 } : overflowedState();
+        return true;
+    }
+};
+
+// A rule set that is fully known at compile time
+// The fold over || stops at the first rule that matches, exactly like the interpreter does.
+template <typename... Rules>
+struct StaticRuleSet
+{
+    constexpr EvolvedState operator()(int64_t s) const
+    {
+        EvolvedState out{ {s}, 1 };
+        (Rules::apply(s, out) || ...);
+        return out;
+    }
+};
+
+//-------------------------------------------------------------------
+// Runtime rules
+// This is the interpreted fallback for rule sets that are only known
+// once we've read them in from a file.
+//-------------------------------------------------------------------
+class RuleSet
+{
+public:
+
+    enum class Kind { Equals, Split, Multiply };
+
+    // A single rule, where the meaning of the arguments depends on the kind
+    //     - Equals:   a is the value to match, b is the replacement
+    //     - Split:    a is the base, b is the number of parts
+    //     - Multiply: a is the multiplier
+    struct Rule
+    {
+        Kind kind;
+        int64_t a;
+        int64_t b;
+    };
+
+    RuleSet() = default;
+    explicit RuleSet(std::vector<Rule> rules) : rules_(std::move(rules)) {};
+
+    // Read in a rule set from a file
+    static RuleSet load(const std::string& filename)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open rules file: " + filename);
+        }
+
+        std::vector<Rule> rules;
+        std::string line;
+        while (std::getline(file, line)) {
+            // Drop comments, and skip anything that is left blank
+            line = line.substr(0, line.find('#'));
+            std::istringstream iss(line);
+            std::string keyword;
+            if (!(iss >> keyword)) continue;
+
+            Rule rule{};
+            std::string arrow;
+            if (keyword == "equals" && iss >> rule.a >> arrow >> rule.b && arrow == "->") {
+                rule.kind = Kind::Equals;
+            }
+            else if (keyword == "split" && iss >> rule.a >> rule.b && rule.a >= 2 && rule.b >= 2 && rule.b <= maxEvolvedStones) {
+                rule.kind = Kind::Split;
+            }
+            else if (keyword == "multiply" && iss >> rule.a) {
+                rule.kind = Kind::Multiply;
+            }
+            else {
+                throw std::runtime_error("Invalid rule: " + line);
+            }
+
+            // Anything trailing the rule is a mistake
+            std::string trailing;
+            if (iss >> trailing) {
+                throw std::runtime_error("Invalid rule: " + line);
+            }
+            rules.push_back(rule);
+        }
+
+        return RuleSet(std::move(rules));
+    };
+
+    // Apply the first matching rule to a stone
+    EvolvedState operator()(int64_t s) const
+    {
+        for (const auto& rule : rules_)
+        {
+            switch (rule.kind)
+            {
+            case Kind::Equals:
+                if (s == rule.a) return EvolvedState{ {rule.b}, 1 };
+                break;
+            case Kind::Split:
+            {
+                const int digitCount = countDigits(s, rule.a);
+                if (digitCount % rule.b == 0) return splitDigits(s, rule.a, static_cast<int>(rule.b), digitCount);
+                break;
+            }
+            case Kind::Multiply:
+                return checkedMultiply(s, rule.a) ? EvolvedState{ {s}, 1 } : overflowedState();
+            }
+        }
+
+        // No rule matched, so the stone doesn't change
+        return EvolvedState{ {s}, 1 };
+    };
+
+    const std::vector<Rule>& rules() const { return rules_; };
+
+private:
+    std::vector<Rule> rules_;
+};
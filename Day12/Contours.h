@@ -0,0 +1,257 @@
+﻿//********************************************************
+// Fence Contours
+//
+// The actual fences around every region of a garden, as
+// polygons, rather than just their costs.
+//
+// First every cell is labelled with the connected region
+// it belongs to, with a flood fill. Then the boundary of
+// every region is followed around, on the grid of cell
+// corners, one fence side at a time:
+// - walking so that the region is always on the right
+// - turning left if the cell ahead and to the left is
+//   part of the region (and so is the one ahead)
+// - going straight if only the cell ahead is
+// - turning right otherwise
+// Only the corners where we turn are kept, so each ring
+// is made up of straight runs of fence, and the number of
+// sides is just the number of corners. Following a ring
+// only ever touches the fence sides that are on it, so it
+// costs O(perimeter).
+//
+// Outer boundaries go clockwise (as drawn, with rows
+// going down), and the holes inside a region go counter
+// clockwise, so which one a ring is comes straight out of
+// the sign of its area. Two cells of a region that only
+// touch at a corner aren't connected, so a ring can touch
+// itself at a corner like that.
+//
+// Every region is traced independently, so they're all
+// traced in parallel (see Parallel.h).
+//
+// The labelling and tracing are templated on the garden,
+// which can be a row major Grid or a TiledGrid (see
+// TiledGrid.h), and only ever get from a cell to its
+// neighbours through the garden's neighbour accessor.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+#include "TiledGrid.h"
+#include "Parallel.h"
+
+// A corner of the grid of cells
+// Corner (row, col) is the top left corner of cell (row, col), so a garden with H rows and W
+// columns has corners from (0, 0) to (H, W).
+struct FencePoint
+{
+	int row;
+	int col;
+	bool operator==(const FencePoint&) const = default;
+};
+
+// The fence around one region
+struct FencePolygon
+{
+	char letter = 0;
+	int area = 0;
+	int perimeter = 0;
+	int sides = 0;
+	std::vector<FencePoint> outer;                  // Clockwise
+	std::vector<std::vector<FencePoint>> holes;     // Counter clockwise
+
+	// The costs of fencing the region, either by perimeter or by sides
+	int64_t cost() const { return static_cast<int64_t>(area) * perimeter; };
+	int64_t discountedCost() const { return static_cast<int64_t>(area) * sides; };
+};
+
+// Every cell of a garden, labelled by region
+// labels[garden.index(row, col)] is the region the cell belongs to, and -1 for any storage that
+// isn't a cell. Regions are numbered in the order of their first cell, in the order the garden
+// stores its cells (row by row for a Grid), and cells lists each region's cells (by index) in
+// that same order, cells[cellStarts[r]] to cells[cellStarts[r + 1] - 1].
+struct RegionLabels
+{
+	std::vector<int> labels;
+	std::vector<uint32_t> cellStarts;
+	std::vector<uint32_t> cells;
+	int count() const { return static_cast<int>(cellStarts.size()) - 1; };
+};
+
+// Label every cell with its region
+template <typename Garden>
+RegionLabels labelRegions(const Garden& garden)
+{
+	RegionLabels regions;
+	regions.labels.assign(garden.size(), -1);
+
+	// Flood fill each region from the first cell we find that isn't labelled yet
+	// The garden is walked in the order it's stored, so that it's walked through memory in order
+	// Cells on the stack keep their row and column, so they never have to be worked out again
+	struct StackedCell { size_t i; int row; int col; };
+	std::vector<StackedCell> stack;
+	std::vector<uint32_t> sizes;
+	garden.forEachCell([&](size_t start, int startRow, int startCol)
+		{
+			if (regions.labels[start] != -1) return;
+
+			const int label = static_cast<int>(sizes.size());
+			const char letter = garden.at(start);
+			uint32_t size = 0;
+			regions.labels[start] = label;
+			stack.push_back({ start, startRow, startCol });
+			while (!stack.empty())
+			{
+				const auto [cell, row, col] = stack.back();
+				stack.pop_back();
+				size++;
+				for (int d = 0; d < 4; d++)
+				{
+					if (!garden.inBounds(row + gridRowStep[d], col + gridColStep[d])) continue;
+					const size_t next = garden.neighbour(cell, row, col, static_cast<GridDirection>(d));
+					if (garden.at(next) == letter && regions.labels[next] == -1)
+					{
+						regions.labels[next] = label;
+						stack.push_back({ next, row + gridRowStep[d], col + gridColStep[d] });
+					}
+				}
+			}
+			sizes.push_back(size);
+		});
+
+	// Group the cells by region, with a counting sort so they stay in the same order
+	regions.cellStarts.assign(sizes.size() + 1, 0);
+	for (size_t r = 0; r < sizes.size(); r++)
+	{
+		regions.cellStarts[r + 1] = regions.cellStarts[r] + sizes[r];
+	}
+	std::vector<uint32_t> next(regions.cellStarts.begin(), regions.cellStarts.end() - 1);
+	regions.cells.resize(regions.cellStarts.back());
+	garden.forEachCell([&](size_t cell, int, int)
+		{
+			regions.cells[next[regions.labels[cell]]++] = static_cast<uint32_t>(cell);
+		});
+	return regions;
+}
+
+// Trace the fences of one region
+// traced has a bit for every side of every cell, and is only touched for cells in this region,
+// so any number of regions can be traced at the same time.
+template <typename Garden>
+FencePolygon traceRegion(const Garden& garden, const RegionLabels& regions, int label, std::vector<uint8_t>& traced)
+{
+	// Is the neighbour of cell i, at (row, col), in this region?
+	auto inRegion = [&](size_t i, int row, int col, int direction)
+		{
+			return garden.inBounds(row + gridRowStep[direction], col + gridColStep[direction]) &&
+				regions.labels[garden.neighbour(i, row, col, static_cast<GridDirection>(direction))] == label;
+		};
+
+	FencePolygon polygon;
+	const uint32_t first = regions.cellStarts[label];
+	const uint32_t last = regions.cellStarts[label + 1];
+	polygon.letter = garden.at(regions.cells[first]);
+	polygon.area = static_cast<int>(last - first);
+
+	// Every fence side that hasn't been traced yet starts a new ring
+	for (uint32_t k = first; k < last; k++)
+	{
+		const uint32_t cell = regions.cells[k];
+		const int row = garden.rowOf(cell);
+		const int col = garden.colOf(cell);
+		for (int side = 0; side < 4; side++)
+		{
+			if ((traced[cell] >> side & 1) || inRegion(cell, row, col, side)) continue;
+
+			// The fence on this side of the cell runs with the cell on its right, so we're heading
+			// one turn clockwise from the side it's on
+			std::vector<FencePoint> ring;
+			int64_t doubleArea = 0;
+			size_t i = cell;
+			int r = row;
+			int c = col;
+			int s = side;
+			do
+			{
+				traced[i] |= static_cast<uint8_t>(1 << s);
+				polygon.perimeter++;
+				const int heading = (s + 1) % 4;
+
+				// The corner at the end of this side, which is where we might turn
+				const FencePoint end = {
+					r + (s == GridDown || heading == GridDown ? 1 : 0),
+					c + (s == GridRight || heading == GridRight ? 1 : 0) };
+
+				if (inRegion(i, r, c, heading))
+				{
+					const size_t ahead = garden.neighbour(i, r, c, static_cast<GridDirection>(heading));
+					const int aheadRow = r + gridRowStep[heading];
+					const int aheadCol = c + gridColStep[heading];
+					if (inRegion(ahead, aheadRow, aheadCol, s))
+					{
+						// Turn left, onto the cell ahead and to the left
+						i = garden.neighbour(ahead, aheadRow, aheadCol, static_cast<GridDirection>(s));
+						r = aheadRow + gridRowStep[s];
+						c = aheadCol + gridColStep[s];
+						s = (s + 3) % 4;
+						ring.push_back(end);
+					}
+					else
+					{
+						// Straight on
+						i = ahead;
+						r = aheadRow;
+						c = aheadCol;
+					}
+				}
+				else
+				{
+					// Turn right, around the same cell
+					s = heading;
+					ring.push_back(end);
+				}
+			} while (!(i == cell && s == side));
+
+			// The shoelace formula, which is positive for clockwise rings with rows going down
+			for (size_t i = 0; i < ring.size(); i++)
+			{
+				const FencePoint& a = ring[i];
+				const FencePoint& b = ring[(i + 1) % ring.size()];
+				doubleArea += static_cast<int64_t>(a.col) * b.row - static_cast<int64_t>(b.col) * a.row;
+			}
+
+			polygon.sides += static_cast<int>(ring.size());
+			if (doubleArea > 0)
+			{
+				polygon.outer = std::move(ring);
+			}
+			else
+			{
+				polygon.holes.push_back(std::move(ring));
+			}
+		}
+	}
+	return polygon;
+}
+
+// Trace the fences around every region of a garden, in the same order as labelRegions
+template <typename Garden>
+std::vector<FencePolygon> traceFences(const Garden& garden)
+{
+	const RegionLabels regions = labelRegions(garden);
+	std::vector<FencePolygon> polygons(regions.count());
+	std::vector<uint8_t> traced(garden.size(), 0);
+
+	// Most regions are small, so they're handed out a few at a time
+	parallelFor(0, polygons.size(), 16, [&](size_t first, size_t last)
+		{
+			for (size_t label = first; label < last; label++)
+			{
+				polygons[label] = traceRegion(garden, regions, static_cast<int>(label), traced);
+			}
+		});
+	return polygons;
+}
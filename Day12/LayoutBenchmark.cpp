@@ -0,0 +1,123 @@
+﻿//********************************************************
+// Layout Benchmark
+//
+// Times labelling the regions of a wide garden, and then
+// tracing all of their fences (see Contours.h), with the
+// garden stored row major (Grid) and in Morton ordered
+// tiles (TiledGrid). Both have to come up with the same
+// answers.
+//
+// The garden is random, with blobs of the same letter so
+// that the regions have some size to them.
+//
+// Fewer letters give fewer, bigger regions, which spread
+// further up and down the garden.
+//
+// Usage: Day12LayoutBenchmark [width] [height] [letters] [repeats]
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include "Grid.h"
+#include "TiledGrid.h"
+#include "ScopedTimer.h"
+#include "ThreadPool.h"
+#include "Contours.h"
+
+// Forward declarations
+Grid makeGarden(int width, int height, int letters);
+
+// The median time, in ms, of running f a number of times
+template <typename F>
+double medianTime(int repeats, F f)
+{
+	std::vector<double> times;
+	for (int i = 0; i < repeats; i++)
+	{
+		ScopedTimer timer;
+		f();
+		times.push_back(timer.elapsed());
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+int main(int argc, char* argv[])
+{
+	const int width = argc > 1 ? std::stoi(argv[1]) : 16384;
+	const int height = argc > 2 ? std::stoi(argv[2]) : 1024;
+	const int letters = argc > 3 ? std::clamp(std::stoi(argv[3]), 1, 26) : 8;
+	const int repeats = argc > 4 ? std::max(1, std::stoi(argv[4])) : 3;
+	setThreadCountFromEnvironment();
+
+	std::cout << "Garden of " << width << " x " << height << " with " << letters << " letters, median of " << repeats << " runs" << std::endl;
+	const Grid rowMajor = makeGarden(width, height, letters);
+
+	ScopedTimer timer;
+	const TiledGrid tiled(rowMajor);
+	std::cout << "Tiling the garden took " << timer.elapsed() << " ms" << std::endl;
+
+	// Run both steps on one layout, and add up what we get, so that the layouts can be compared
+	auto run = [&](const auto& garden, const std::string& label)
+		{
+			int regions = 0;
+			const double labelMs = medianTime(repeats, [&] { regions = labelRegions(garden).count(); });
+
+			int64_t cost = 0;
+			int64_t discountedCost = 0;
+			const double traceMs = medianTime(repeats, [&]
+				{
+					cost = 0;
+					discountedCost = 0;
+					for (const auto& fence : traceFences(garden))
+					{
+						cost += fence.cost();
+						discountedCost += fence.discountedCost();
+					}
+				});
+
+			std::cout << "[" << label << "] " << regions << " regions, costs " << cost << " and " << discountedCost << std::endl;
+			std::cout << "[" << label << "] Labelling: " << labelMs << " ms, labelling and tracing: " << traceMs << " ms" << std::endl;
+			return std::make_pair(cost, discountedCost);
+		};
+
+	const auto rowMajorCosts = run(rowMajor, "row major");
+	const auto tiledCosts = run(tiled, "tiled");
+	if (rowMajorCosts != tiledCosts)
+	{
+		std::cerr << "Error: The layouts disagree" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// A random garden, with blobs of the same letter rather than noise
+Grid makeGarden(int width, int height, int letters)
+{
+	std::mt19937 random(12);
+	Grid garden(width, height);
+	for (int i = 0; i < height; i++)
+	{
+		for (int j = 0; j < width; j++)
+		{
+			garden(i, j) = static_cast<char>('A' + random() % letters);
+		}
+	}
+
+	// Let each cell copy a neighbour a few times over, so the letters clump together
+	for (int pass = 0; pass < 4; pass++)
+	{
+		for (int i = 0; i < height; i++)
+		{
+			for (int j = 0; j < width; j++)
+			{
+				const int d = static_cast<int>(random() % 4);
+				if (garden.inBounds(i + gridRowStep[d], j + gridColStep[d])) garden(i, j) = garden(i + gridRowStep[d], j + gridColStep[d]);
+			}
+		}
+	}
+	return garden;
+}
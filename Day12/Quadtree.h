@@ -0,0 +1,268 @@
+﻿//********************************************************
+// Garden Quadtree
+//
+// A region quadtree over the labelled garden (see
+// Contours.h). The garden is padded out to a square whose
+// side is a power of two, and then split into quarters,
+// and those into quarters, until every square is all one
+// region. A square that's all one region is a single node
+// no matter how big it is, so a garden with big plain
+// areas takes far fewer nodes than it has cells.
+//
+// The area and perimeter of every region come straight
+// out of the tree:
+// - a plain square of side s adds s * s to the area of
+//   its region, and 4 * s to its perimeter
+// - wherever two neighbouring squares belong to the same
+//   region, the fence between them isn't really there, so
+//   every cell of border they share takes 2 back off
+// The only borders that have to be checked are the lines
+// between the four quarters of every split square, and
+// only the squares that touch those lines are looked at,
+// so the work follows how complicated the boundaries are,
+// not how big the garden is.
+//
+// The tree can also be read at any depth, which gives a
+// zoomed out view of the garden (see zoomedOut).
+//********************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Grid.h"
+#include "Contours.h"
+
+//-------------------------------------------------------------------
+// This class is a garden stored as a region quadtree
+// The children of a split node are stored next to each other, in the
+// order top left, top right, bottom left, bottom right.
+//-------------------------------------------------------------------
+class QuadGarden
+{
+public:
+
+	// The label of the padding outside the garden, and of a node that's been split
+	static constexpr int32_t outside = -1;
+	static constexpr int32_t split = -2;
+
+	// Constructor
+	// Labels the garden's regions, then builds the tree from the labels
+	explicit QuadGarden(const Grid& garden) : width_(garden.width()), height_(garden.height())
+	{
+		const RegionLabels regions = labelRegions(garden);
+		letters_.resize(regions.count());
+		for (int r = 0; r < regions.count(); r++)
+		{
+			letters_[r] = garden.at(regions.cells[regions.cellStarts[r]]);
+		}
+
+		size_ = 1;
+		while (size_ < width_ || size_ < height_) size_ *= 2;
+		root_ = build(garden, regions.labels, 0, 0, size_);
+	};
+
+	// Getters
+	int width() const { return width_; };
+	int height() const { return height_; };
+	size_t nodeCount() const { return nodes_.size() + 1; };
+	int regionCount() const { return static_cast<int>(letters_.size()); };
+	char letter(int region) const { return letters_[region]; };
+
+	// Work out the area and perimeter of every region, indexed by region
+	void measure(std::vector<int64_t>& areas, std::vector<int64_t>& perimeters) const
+	{
+		areas.assign(letters_.size(), 0);
+		perimeters.assign(letters_.size(), 0);
+		measure(root_, size_, areas, perimeters);
+	};
+
+	// The total cost of fencing every region, by area times perimeter
+	int64_t cost() const
+	{
+		std::vector<int64_t> areas, perimeters;
+		measure(areas, perimeters);
+		int64_t cost = 0;
+		for (size_t r = 0; r < areas.size(); r++)
+		{
+			cost += areas[r] * perimeters[r];
+		}
+		return cost;
+	};
+
+	// The letter of one cell, found by walking down the tree
+	char letterAt(int row, int col) const
+	{
+		Node node = root_;
+		int size = size_;
+		while (node.label == split)
+		{
+			size /= 2;
+			const int quarter = (row >= size ? 2 : 0) + (col >= size ? 1 : 0);
+			row %= size;
+			col %= size;
+			node = nodes_[node.children + quarter];
+		}
+		return node.label == outside ? '\0' : letters_[node.label];
+	};
+
+	// A zoomed out view of the garden, with every square of 2^level by 2^level cells shrunk
+	// down to one cell
+	// Squares that are all one region show its letter, and squares with more than one show
+	// mixed, as do squares on the far edges that are partly padding. Only the top levels of the
+	// tree are ever looked at.
+	Grid zoomedOut(int level, char mixed = '+') const
+	{
+		const int scale = 1 << level;
+		Grid view((width_ + scale - 1) / scale, (height_ + scale - 1) / scale, mixed);
+		paint(view, root_, 0, 0, size_, scale, mixed);
+		return view;
+	};
+
+private:
+
+	// A node is either a square that's all one region (or all outside), or split into four
+	struct Node
+	{
+		int32_t label = outside;
+		uint32_t children = 0;
+	};
+
+	// Build the node for the square of the given size at (row, col)
+	// The four children are given their place before they're built, and if they all come
+	// out as the same plain square, they're taken away again and this becomes one too. Plain
+	// children don't have any children of their own, so they're always the last four nodes.
+	Node build(const Grid& garden, const std::vector<int>& labels, int row, int col, int size)
+	{
+		if (row >= height_ || col >= width_) return { outside, 0 };
+		if (size == 1) return { labels[garden.index(row, col)], 0 };
+
+		const int half = size / 2;
+		const uint32_t first = static_cast<uint32_t>(nodes_.size());
+		nodes_.resize(first + 4);
+		for (int quarter = 0; quarter < 4; quarter++)
+		{
+			const Node child = build(garden, labels, row + (quarter / 2) * half, col + (quarter % 2) * half, half);
+			nodes_[first + quarter] = child;
+		}
+
+		const int32_t label = nodes_[first].label;
+		bool plain = label != split;
+		for (int quarter = 1; quarter < 4 && plain; quarter++)
+		{
+			plain = nodes_[first + quarter].label == label;
+		}
+		if (plain)
+		{
+			nodes_.resize(first);
+			return { label, 0 };
+		}
+		return { split, first };
+	};
+
+	// Add up the area and perimeter of everything under a node
+	void measure(const Node& node, int size, std::vector<int64_t>& areas, std::vector<int64_t>& perimeters) const
+	{
+		if (node.label == outside) return;
+		if (node.label != split)
+		{
+			areas[node.label] += static_cast<int64_t>(size) * size;
+			perimeters[node.label] += 4 * static_cast<int64_t>(size);
+			return;
+		}
+
+		const int half = size / 2;
+		const Node* children = &nodes_[node.children];
+		for (int quarter = 0; quarter < 4; quarter++)
+		{
+			measure(children[quarter], half, areas, perimeters);
+		}
+
+		// Stitch the quarters back together along the lines between them: the right edges of
+		// the left quarters against the left edges of the right quarters, and the bottom
+		// edges of the top quarters against the top edges of the bottom quarters
+		stitch(children[0], children[1], half, GridRight, perimeters);
+		stitch(children[2], children[3], half, GridRight, perimeters);
+		stitch(children[0], children[2], half, GridDown, perimeters);
+		stitch(children[1], children[3], half, GridDown, perimeters);
+	};
+
+	// Take the fence back off where two neighbouring squares of the same size share a border
+	// and are in the same region. direction is which way b is from a.
+	void stitch(const Node& a, const Node& b, int size, GridDirection direction, std::vector<int64_t>& perimeters) const
+	{
+		std::vector<std::pair<int32_t, int>> aRuns, bRuns;
+		edgeRuns(a, size, direction, aRuns);
+		edgeRuns(b, size, static_cast<GridDirection>((direction + 2) % 4), bRuns);
+
+		// Walk along both edges at once, a run at a time
+		size_t i = 0, j = 0;
+		int aLeft = aRuns[0].second, bLeft = bRuns[0].second;
+		while (i < aRuns.size() && j < bRuns.size())
+		{
+			const int shared = std::min(aLeft, bLeft);
+			if (aRuns[i].first == bRuns[j].first && aRuns[i].first >= 0)
+			{
+				perimeters[aRuns[i].first] -= 2 * static_cast<int64_t>(shared);
+			}
+			aLeft -= shared;
+			bLeft -= shared;
+			if (aLeft == 0 && ++i < aRuns.size()) aLeft = aRuns[i].second;
+			if (bLeft == 0 && ++j < bRuns.size()) bLeft = bRuns[j].second;
+		}
+	};
+
+	// The labels along one edge of a square, as runs of (label, length), going left to right
+	// along the top or bottom edges, and top to bottom along the left or right ones
+	void edgeRuns(const Node& node, int size, GridDirection side, std::vector<std::pair<int32_t, int>>& runs) const
+	{
+		if (node.label != split)
+		{
+			if (!runs.empty() && runs.back().first == node.label) runs.back().second += size;
+			else runs.emplace_back(node.label, size);
+			return;
+		}
+
+		// The two quarters along that edge, in order
+		static constexpr int alongEdge[4][2] = { { 0, 1 }, { 1, 3 }, { 2, 3 }, { 0, 2 } };
+		const Node* children = &nodes_[node.children];
+		edgeRuns(children[alongEdge[side][0]], size / 2, side, runs);
+		edgeRuns(children[alongEdge[side][1]], size / 2, side, runs);
+	};
+
+	// Fill in the zoomed out view for everything under a node
+	void paint(Grid& view, const Node& node, int row, int col, int size, int scale, char mixed) const
+	{
+		if (row >= height_ || col >= width_) return;
+		if (node.label != split || size <= scale)
+		{
+			// Squares are lined up on multiples of their size, so this covers whole view cells
+			const char letter = node.label == split ? mixed : node.label == outside ? '\0' : letters_[node.label];
+			const int rowEnd = std::min(height_, row + size);
+			const int colEnd = std::min(width_, col + size);
+			for (int i = row / scale; i <= (rowEnd - 1) / scale; i++)
+			{
+				for (int j = col / scale; j <= (colEnd - 1) / scale; j++)
+				{
+					view(i, j) = letter;
+				}
+			}
+			return;
+		}
+
+		const int half = size / 2;
+		for (int quarter = 0; quarter < 4; quarter++)
+		{
+			paint(view, nodes_[node.children + quarter], row + (quarter / 2) * half, col + (quarter % 2) * half, half, scale, mixed);
+		}
+	};
+
+	int width_ = 0;
+	int height_ = 0;
+	int size_ = 1;
+	std::vector<char> letters_;
+	std::vector<Node> nodes_;
+	Node root_;
+};
@@ -0,0 +1,166 @@
+//********************************************************
+// Dampener
+//
+// Checks whether a report can be made safe by removing
+// up to k of its levels.
+//
+// For k = 1 there's a single pass over the report that
+// keeps track of whether it's still safe so far with and
+// without having removed a level, in each direction.
+//
+// For any other k, we use a dynamic program over the
+// levels. For each level i, we work out the fewest levels
+// we need to remove from the start of the report up to i
+// so that it's safe, with level i being the last one
+// kept. Only the previous k + 1 levels can be the level
+// kept before i (any further back and we'd have removed
+// more than k levels in between), so each level costs at
+// most k + 1 checks, and the whole report O(n k).
+//********************************************************
+
+#pragma once
+
+#include "Reports.h"
+#include "SafetyKernel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Does level b follow on safely from level a, in the given direction?
+inline bool followsSafely(int a, int b, int direction)
+{
+    const int64_t d = levelDifference(a, b);
+    return direction > 0 ? isSafeStepUp(d) : isSafeStepDown(d);
+}
+
+// Is a given report safe if we're allowed to remove a single level from it?
+// This walks the report once for each direction, keeping track of two things as it goes:
+// - keep:   the report is safe up to and including level i, with nothing removed
+// - damped: the report is safe up to and including level i, with one level removed
+// The removed level is either somewhere before i - 1, in which case level i just has to
+// follow on from level i - 1, or it is level i - 1 itself, in which case level i has to
+// follow on from level i - 2, and nothing before that can have been removed.
+// At the end, the report is safe if it made it all the way with at most one removal, or
+// if it made it up to the second to last level with nothing removed, as we can then
+// remove the last level.
+inline bool isReportSafeDampened(std::span<const int> v)
+{
+    // Removing a level from a report with 2 or fewer levels always leaves a safe report
+    const size_t n = v.size();
+    if (n <= 2) return true;
+
+    for (const int direction : { 1, -1 })
+    {
+        // The state at levels i - 2 and i - 1
+        // Removing level 0 means the report starts at level 1, so that's always safe
+        bool keepBefore = true;
+        bool keep = followsSafely(v[0], v[1], direction);
+        bool damped = true;
+        for (size_t i = 2; i < n; i++)
+        {
+            const bool nextDamped = (damped && followsSafely(v[i - 1], v[i], direction)) || (keepBefore && followsSafely(v[i - 2], v[i], direction));
+            const bool nextKeep = keep && followsSafely(v[i - 1], v[i], direction);
+            keepBefore = keep;
+            keep = nextKeep;
+            damped = nextDamped;
+        }
+
+        if (keep || damped || keepBefore) return true;
+    }
+
+    return false;
+}
+
+// Is a given report safe if we're allowed to remove up to k levels from it?
+// scratch is working space for the dynamic program, which can be reused between calls so
+// that checking a lot of reports doesn't allocate every time.
+inline bool isReportSafeWithDampening(std::span<const int> v, int k, std::vector<int>& scratch)
+{
+    // Removing everything but one level always leaves a safe report
+    const size_t n = v.size();
+    const size_t removals = static_cast<size_t>(std::max(k, 0));
+    if (n <= removals + 1) return true;
+
+    // The cheaper checks, for the common cases
+    if (k <= 0)
+    {
+        for (const int direction : { 1, -1 })
+        {
+            size_t i = 1;
+            while (i < n && followsSafely(v[i - 1], v[i], direction)) i++;
+            if (i == n) return true;
+        }
+        return false;
+    }
+    if (k == 1) return isReportSafeDampened(v);
+
+    // fewest[i % window] is the fewest removals needed to make levels 0 to i safe, with level i
+    // being the last one kept. Only the last k + 2 entries are ever looked at, so it's kept as
+    // a ring.
+    const size_t window = removals + 2;
+    const int tooMany = k + 1;
+    scratch.resize(window);
+
+    for (const int direction : { 1, -1 })
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            // We can always start fresh at level i, by removing everything before it
+            int best = i <= removals ? static_cast<int>(i) : tooMany;
+
+            // Or we can keep level p just before it, removing everything in between
+            const size_t firstP = i > removals + 1 ? i - removals - 1 : 0;
+            for (size_t p = firstP; p < i; p++)
+            {
+                const int cost = scratch[p % window] + static_cast<int>(i - p - 1);
+                if (cost < best && followsSafely(v[p], v[i], direction)) best = cost;
+            }
+            scratch[i % window] = best;
+
+            // Finishing at level i means removing everything after it
+            if (best + static_cast<int>(n - 1 - i) <= k) return true;
+        }
+    }
+
+    return false;
+}
+
+// Is a given report safe if we're allowed to remove up to k levels from it?
+inline bool isReportSafeWithDampening(std::span<const int> v, int k)
+{
+    std::vector<int> scratch;
+    return isReportSafeWithDampening(v, k, scratch);
+}
+
+// Work out which reports are safe if we're allowed to remove up to k levels from each, starting
+// from which ones are safe as they are
+// safe and safeCount come from classifyReports, and safe is updated in place, so that the safety
+// kernel's answers are reused rather than worked out again. Any report that's safe as it is, is
+// safe with the dampener, so only the ones left over go through the dynamic program. The number
+// of safe reports is returned.
+inline size_t classifyReportsWithDampening(const Reports& reports, int k, std::vector<uint8_t>& safe, size_t safeCount)
+{
+    if (k <= 0) return safeCount;
+
+    std::vector<int> scratch;
+    for (size_t r = 0; r < reports.size(); r++)
+    {
+        if (!safe[r] && isReportSafeWithDampening(reports[r], k, scratch))
+        {
+            safe[r] = 1;
+            safeCount++;
+        }
+    }
+    return safeCount;
+}
+
+// Work out which reports are safe if we're allowed to remove up to k levels from each
+// safe[i] is set to 1 if report i is safe and 0 if it isn't, and the number of safe reports is
+// returned
+inline size_t classifyReportsWithDampening(const Reports& reports, int k, std::vector<uint8_t>& safe)
+{
+    const size_t safeCount = classifyReports(reports, safe);
+    return classifyReportsWithDampening(reports, k, safe, safeCount);
+}
@@ -5,169 +5,109 @@
 // Date: December 2 2024
 // https://adventofcode.com/2024/day/2
 // 
-// In order to solve this problem, I'll just be using a
-// simple iterative method, where we iterate over each
-// entry in each report one at a time, and do a forward
-// comparison to see if the rules of a safe report are
-// violated or not. The scope of the problem is quite
-// small so no optimization has been done.
+// For part 1, every report is classified at once by the
+// safety kernel (see SafetyKernel.h), which checks the
+// differences between neighbouring levels for a whole
+// block of reports with vector instructions.
+//
+// For part 2, rather than building every possible
+// dampened report and checking each one, the dampener
+// (see Dampener.h) works out directly whether removing
+// up to K levels can make a report safe.
+//
+// The reports are stored flat, in one array of levels
+// with an array of offsets into it (see Reports.h), and
+// each report is handed around as a span.
+//
+// The file is never loaded all at once. It's streamed
+// through in chunks (see ReportStream.h), with each chunk
+// classified for both problems on a worker thread, and
+// the counts from every chunk added up at the end.
 //********************************************************
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <span>
+#include "Reports.h"
+#include "SafetyKernel.h"
+#include "Dampener.h"
+#include "ReportStream.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Allocations.h"
+
+// How many reports in a chunk are safe, with and without the problem dampener
+struct SafetyCounts
+{
+    size_t safe = 0;
+    size_t dampenedSafe = 0;
 
-// Forward Declarations
-std::vector<std::vector<int>> readFile(const std::string& name);
+    SafetyCounts& operator+=(const SafetyCounts& other)
+    {
+        safe += other.safe;
+        dampenedSafe += other.dampenedSafe;
+        return *this;
+    };
+};
 
 int main(void)
 {
     // Input
 	//const std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day2\\smallexample.txt";
 	const std::string fileName = "C:\\Users\\sahil\\OneDrive\\Documents\\advent\\day2\\myinput.txt";
-    std::vector<std::vector<int>> reports = readFile(fileName);
 
-    // Is a given report safe?
-    // The rules here are as follows. For a given report to be safe, it must:
-    // - either be strictly increasing or decreasing
-    // - must not vary by more than 3 between subsequent entries
-    auto isReportSafe = [](const std::vector<int> & v) 
-        {
-            // First entry check
-            // This is done separately in order to establish the increasing/decreasing behavior
-            bool isIncreasing = v[0] < v[1];
-            int absDifference = fabs(v[0] - v[1]);
-            if ((absDifference < 1) || (absDifference > 3)) return false;
-
-            // Check the rest of the entries to see if they maintain the pattern set by the first
-            // couple of entries
-            bool isSafe = true;
-            bool maintainsIncreasePattern = true;
-            bool maintainsDifferencePattern = true;
-            for (int i = 1; i < v.size() - 1; i++)
-            {
-                // Check to see that if the report started with an increase, that it keeps increasing
-                // Note that if the entries are equal, this will return false
-                if (isIncreasing) maintainsIncreasePattern = v[i] < v[i + 1];
-                else maintainsIncreasePattern &= v[i] > v[i + 1];
+    // The number of threads can be limited with AOC_THREADS
+    setThreadCountFromEnvironment();
 
-                // Check to make sure that the difference between subsequent entries is not too big
-                int absDifference = fabs(v[i] - v[i + 1]);
-                if ((absDifference < 1) || (absDifference > 3)) maintainsDifferencePattern = false;
+    // How many bad levels can the problem dampener tolerate?
+    const int K = 1;
 
-                // If either the increase pattern or the difference rule was not satisfied, this
-                // entire report is not safe, so break the rest of the analysis, and mark this
-                // report as unsafe
-                if (!maintainsIncreasePattern || !maintainsDifferencePattern)
-                {
-                    isSafe = false;
-                    break;
-                }
-            }
-
-            // Final return for this particular report
-            return isSafe;
-        };
-
-    // For a given report, generate the list of possible dampened reports
-    // This is where the brute force/unoptimized nature of this solution
-    // comes in. For part 2 of this problem, we need to see if removal of
-    // any one entry will make the entire report safe. This function
-    // generates that list of possible reports. In general, if I have a
-    // report that is length N, this will give me N+1 reports (the case
-    // where no entries have been removed is also included).
-    auto dampenedLevelReports = [](const std::vector<int> v)
+    // Classify every report in a chunk for both problems
+    auto classify = [&](const Reports& reports)
         {
-            std::vector<std::vector<int>> dampenedReports;
-            dampenedReports.push_back(v);
-            for (int i = 0; i < v.size(); i++)
+            SafetyCounts counts;
+
+            //----------------------------------------------------
+            // Problem 1
+            // How many safe reports are in this list of reports?
+            //----------------------------------------------------
+            // The rules here are as follows. For a given report to be safe, it must:
+            // - either be strictly increasing or decreasing
+            // - must not vary by more than 3 between subsequent entries
+            std::vector<uint8_t> safeReports;
             {
-                // Create a copy of the report
-                std::vector<int> dampenedReport = v;
-
-                // Erase the ith entry
-                dampenedReport.erase(dampenedReport.begin() + i);
-
-                // Push this back into the list
-                dampenedReports.push_back(dampenedReport);
+                AOC_TRACE_SCOPE("safety kernel");
+                counts.safe = classifyReports(reports, safeReports);
             }
 
-            // Returned all of the possible dampened reports
-            return dampenedReports;
-        };
-
-    //----------------------------------------------------
-    // Problem 1
-    // How many safe reports are in this list of reports?
-    //----------------------------------------------------
-    int safeCount = 0;
-    for (const auto& report : reports)
-    {
-        if(isReportSafe(report))
-        {
-            safeCount++;
-        }
-	}
-	std::cout << "There are " << safeCount << " safe reports." << std::endl;
+            //----------------------------------------------------
+            // Problem 2
+            // How many safe reports are in this list of reports
+            // if we apply the problem dampening?
+            //----------------------------------------------------
+            AOC_TRACE_SCOPE("dampener");
+            counts.dampenedSafe = classifyReportsWithDampening(reports, K, safeReports, counts.safe);
 
+            return counts;
+        };
 
-	//----------------------------------------------------
-    // Problem 2
-    // How many safe reports are in this list of reports
-    // if we apply the problem dampening?
-    //----------------------------------------------------
-    safeCount = 0;
-    for (const auto& report : reports)
+    // Stream the whole file through
+    // The chunks are classified on several threads at once, so they all share one phase
+    SafetyCounts counts;
     {
-        // Find all of the dampened reports
-        std::vector<std::vector<int>> dampenedReports = dampenedLevelReports(report);
-
-        // If any of these reports is safe, this overall report is safe
-        // Note: this could be optimized by doing an iterative process with
-        //       more complex checks. I.e., at each entry, check one or two
-        //       spaces forward, and see if either of those result in a safe
-        //       report or not. However, for the purposes and scope of
-        //       problem laid out here, such an optimization is not
-        //       necessary, and so I've kept it simple.
-        for (const auto& dReport : dampenedReports)
+        AOC_ALLOC_PHASE("classify");
+        if (!streamReports(fileName, classify, counts))
         {
-            if( isReportSafe(dReport) )
-            {
-                safeCount++;
-                break;
-            }
+            std::cerr << "Error: Unable to open file." << std::endl;
+            return 1;
         }
     }
-    std::cout << "There are " << safeCount << " dampened safe reports." << std::endl;
-
-}
-
-// Function that reads in a file name and returns the garden data
-std::vector<std::vector<int>> readFile(const std::string& name) {
-    std::vector<std::vector<int>> intArray;
-
-    std::ifstream file(name);
-    if (!file) {
-        std::cerr << "Error: Unable to open file." << std::endl;
-        return intArray; // Return an empty vector if the file can't be opened
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::vector<int> row;
-        std::istringstream lineStream(line);
-        int num;
 
-        // Parse each integer from the line
-        while (lineStream >> num) {
-            row.push_back(num);
-        }
-
-        intArray.push_back(row);
-    }
+    std::cout << "There are " << counts.safe << " safe reports." << std::endl;
+    std::cout << "There are " << counts.dampenedSafe << " dampened safe reports." << std::endl;
 
-    file.close();
-    return intArray;
-}
\ No newline at end of file
+    AOC_ALLOC_REPORT(std::cout);
+    AOC_TRACE_SAVE("Day2_trace.json");
+    return 0;
+}
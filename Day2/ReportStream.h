@@ -0,0 +1,103 @@
+//********************************************************
+// Report Stream
+//
+// Classifies a file of reports without ever holding the
+// whole thing in memory.
+//
+// The file is read a chunk at a time, and each chunk is
+// cut at its last newline so that no report is ever
+// split between two chunks. Every chunk is then parsed
+// and classified on a worker thread, and the results for
+// each chunk are added up as they finish. The pipeline
+// (see Parallel.h) only lets a fixed number of chunks be
+// in flight at once, so the memory used is bounded by
+// that number times the chunk size, no matter how big
+// the file is.
+//********************************************************
+
+#pragma once
+
+#include "Reports.h"
+
+#include <fstream>
+#include <string>
+#include "Parallel.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+// Stream the reports in a file through a classifier, adding up what it returns for each chunk
+// classify takes the Reports for one chunk and returns a Result, and Results are combined
+// with +=. Returns false if the file couldn't be opened.
+template <typename Result, typename Classify>
+bool streamReports(const std::string& filename, Classify classify, Result& total, size_t chunkBytes = size_t(4) << 20, size_t chunksInFlight = 0)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // By default, keep enough chunks in flight for every thread to have one on the go, and
+    // one more waiting
+    if (chunksInFlight == 0) chunksInFlight = 2 * static_cast<size_t>(threadCount());
+
+    // Whatever came after the last newline of the previous chunk
+    std::string leftover;
+
+    parallelPipeline<std::string>(chunksInFlight,
+        // Read the next chunk, cut at a newline
+        // This is only ever done by one thread at a time, as it's the only thing touching the file
+        [&](std::string& chunk)
+            {
+                AOC_TRACE_SCOPE("read chunk");
+                chunk = std::move(leftover);
+                leftover.clear();
+
+                // Keep reading until we have a newline to cut at, or the file runs out
+                // Normally this is a single read, but a line longer than a whole chunk needs more
+                const char* newline = nullptr;
+                while (file)
+                {
+                    const size_t oldSize = chunk.size();
+                    chunk.resize(oldSize + chunkBytes);
+                    file.read(chunk.data() + oldSize, chunkBytes);
+                    chunk.resize(oldSize + static_cast<size_t>(file.gcount()));
+
+                    // Search backwards for the last newline in what we just read
+                    // Whatever was left over from the last chunk can't have a newline in it
+                    for (size_t i = chunk.size(); i > oldSize; i--)
+                    {
+                        if (chunk[i - 1] == '\n')
+                        {
+                            newline = chunk.data() + i - 1;
+                            break;
+                        }
+                    }
+                    if (newline != nullptr) break;
+                }
+
+                // Hold on to the partial line at the end for the next chunk
+                // If the file has run out, the chunk just gets everything that's left
+                if (newline != nullptr && file)
+                {
+                    const size_t cut = static_cast<size_t>(newline - chunk.data()) + 1;
+                    leftover.assign(chunk, cut, std::string::npos);
+                    chunk.resize(cut);
+                }
+
+                return !chunk.empty();
+            },
+        // Parse and classify the chunk, on whichever thread is free
+        [&](std::string chunk)
+            {
+                const Reports reports = [&] { AOC_TRACE_SCOPE("parse"); return Reports::parse(chunk); }();
+                AOC_TRACE_SCOPE("classify");
+                return classify(reports);
+            },
+        // Add up the results, in whatever order they finish
+        [&](const Result& result)
+            {
+                total += result;
+            });
+
+    return true;
+}
@@ -0,0 +1,87 @@
+//********************************************************
+// Reports
+//
+// Every report in the input, stored flat. Rather than a
+// vector per report, all of the levels live in one
+// values array, and report i is the run of levels from
+// offsets[i] up to offsets[i + 1]. This is the same idea
+// as a CSR (compressed sparse row) matrix.
+//
+// Parsing makes a first pass over the text to count the
+// levels and reports, so that the values and offsets
+// arrays are allocated exactly once each, no matter how
+// many reports there are.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "FastParse.h"
+
+class Reports
+{
+public:
+
+    // Number of reports
+    size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; };
+
+    // The levels of a single report
+    std::span<const int> operator[](size_t i) const
+    {
+        return { values_.data() + offsets_[i], values_.data() + offsets_[i + 1] };
+    };
+
+    // Getters
+    const std::vector<int>& values() const { return values_; };
+    const std::vector<uint32_t>& offsets() const { return offsets_; };
+
+    // Build the reports from text, with one report per line and the levels separated by
+    // whitespace. Blank lines are skipped, and a report stops at the first thing on its line
+    // that isn't a number, with the rest of that line skipped. That's what reading each line
+    // with >> used to do, so a bad line never takes the lines after it down with it.
+    static Reports parse(std::string_view text)
+    {
+        // First pass, count how many numbers and lines there are, so that we know exactly how
+        // much room we need. Every number starts with a digit or a sign that doesn't follow
+        // another character of a number.
+        size_t valueCount = 0;
+        size_t lineCount = 1;
+        bool inNumber = false;
+        for (const char c : text)
+        {
+            const bool isNumberChar = (c >= '0' && c <= '9') || c == '-';
+            if (isNumberChar && !inNumber) valueCount++;
+            if (c == '\n') lineCount++;
+            inNumber = isNumberChar;
+        }
+
+        Reports reports;
+        reports.values_.reserve(valueCount);
+        reports.offsets_.reserve(lineCount + 1);
+        reports.offsets_.push_back(0);
+
+        // Second pass, fill in the levels
+        IntegerScanner scanner(text);
+        do {
+            int level;
+            while (scanner.next(level)) {
+                reports.values_.push_back(level);
+            }
+
+            // The end of a line finishes the current report, as long as it had any levels in it
+            if (reports.values_.size() != reports.offsets_.back())
+            {
+                reports.offsets_.push_back(static_cast<uint32_t>(reports.values_.size()));
+            }
+        } while (scanner.nextLine());
+
+        return reports;
+    };
+
+private:
+    std::vector<int> values_;
+    std::vector<uint32_t> offsets_;
+};
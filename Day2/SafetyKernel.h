@@ -0,0 +1,166 @@
+//********************************************************
+// Safety Kernel
+//
+// Classifies a whole batch of reports as safe or unsafe
+// at once, rather than one report at a time.
+//
+// A report is safe when every difference between
+// neighbouring levels is between 1 and 3, or every one
+// is between -3 and -1. So rather than walking each
+// report, we walk the flat array of levels and work out,
+// for every neighbouring pair, whether it's a safe step
+// up and whether it's a safe step down, storing the
+// answers as two bitmasks. A report is then safe if all
+// of the bits for its pairs are set in one of the masks,
+// which we can check 64 pairs at a time. Pairs that
+// straddle two reports are simply never looked at.
+//
+// The bitmasks can be built 8 pairs at a time with AVX2,
+// or one pair at a time with plain scalar code. The AVX2
+// path is picked at runtime if the CPU supports it, and
+// both paths give exactly the same answers.
+//********************************************************
+
+#pragma once
+
+#include "Reports.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Simd.h"
+
+// Which version of the kernel to use
+enum class SafetyKernel { Auto, Scalar, Avx2 };
+
+// Is the difference between two levels a safe step up, or a safe step down?
+// The difference between two ints can need 33 bits, so it's worked out in 64 bits. Otherwise
+// levels at opposite ends of the range, like -2147483648 and 2147483647, would wrap around to a
+// difference of -1 and look like a safe step.
+inline int64_t levelDifference(int32_t a, int32_t b) { return static_cast<int64_t>(b) - a; }
+inline bool isSafeStepUp(int64_t d) { return d >= 1 && d <= 3; }
+inline bool isSafeStepDown(int64_t d) { return d >= -3 && d <= -1; }
+
+// Build the step masks for pairs [first, last) of the levels, where pair j is v[j] and v[j + 1]
+// Bit j of up/down is set if pair j is a safe step up/down.
+inline void stepMasksScalar(const int* v, size_t first, size_t last, uint64_t* up, uint64_t* down)
+{
+    for (size_t j = first; j < last; j++)
+    {
+        const int64_t d = levelDifference(v[j], v[j + 1]);
+        const uint64_t bit = uint64_t(1) << (j % 64);
+        if (isSafeStepUp(d)) up[j / 64] |= bit;
+        if (isSafeStepDown(d)) down[j / 64] |= bit;
+    }
+}
+
+#ifdef AOC_HAS_AVX2_PATH
+AOC_AVX2_TARGET inline void stepMasksAvx2(const int* v, size_t pairs, uint64_t* up, uint64_t* down)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i minusFour = _mm256_set1_epi32(-4);
+
+    // Do 8 pairs at a time, as long as the 9 levels they need are all there
+    size_t j = 0;
+    for (; j + 8 <= pairs; j += 8)
+    {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + j));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + j + 1));
+        const __m256i d = _mm256_sub_epi32(b, a);
+
+        // The subtraction can wrap, so the direction comes from comparing the levels themselves.
+        // Once we know b > a, the true difference is somewhere in [1, 2^32 - 1], and it's a safe
+        // step up exactly when the wrapped difference is 0 < d < 4. Going down is the same the
+        // other way around, with -4 < d < 0.
+        const __m256i isUp = _mm256_and_si256(_mm256_cmpgt_epi32(b, a), _mm256_and_si256(_mm256_cmpgt_epi32(d, zero), _mm256_cmpgt_epi32(four, d)));
+        const __m256i isDown = _mm256_and_si256(_mm256_cmpgt_epi32(a, b), _mm256_and_si256(_mm256_cmpgt_epi32(zero, d), _mm256_cmpgt_epi32(d, minusFour)));
+
+        // One bit per lane, dropped into place in the masks
+        const uint64_t upBits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(isUp)));
+        const uint64_t downBits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(isDown)));
+        up[j / 64] |= upBits << (j % 64);
+        down[j / 64] |= downBits << (j % 64);
+    }
+
+    // Whatever is left over is done the slow way
+    stepMasksScalar(v, j, pairs, up, down);
+}
+#endif
+
+// Are all of the bits [first, last) set in the mask?
+inline bool allBitsSet(const uint64_t* mask, size_t first, size_t last)
+{
+    while (first < last)
+    {
+        // Check as much of the current word as we can in one go
+        const size_t word = first / 64;
+        const size_t bit = first % 64;
+        const size_t count = std::min<size_t>(64 - bit, last - first);
+        const uint64_t wanted = (count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1)) << bit;
+        if ((mask[word] & wanted) != wanted) return false;
+        first += count;
+    }
+    return true;
+}
+
+// Work out which reports are safe
+// safe[i] is set to 1 if report i is safe and 0 if it isn't, and the number of safe reports is
+// returned
+inline size_t classifyReports(const Reports& reports, std::vector<uint8_t>& safe, SafetyKernel kernel = SafetyKernel::Auto)
+{
+    // Pick which kernel to use
+#ifdef AOC_HAS_AVX2_PATH
+    if (kernel == SafetyKernel::Auto) kernel = AOC_CPU_HAS_AVX2() ? SafetyKernel::Avx2 : SafetyKernel::Scalar;
+#else
+    kernel = SafetyKernel::Scalar;
+#endif
+
+    const int* values = reports.values().data();
+    const uint32_t* offsets = reports.offsets().data();
+    const size_t reportCount = reports.size();
+    safe.assign(reportCount, 0);
+
+    // The reports are done in blocks, so that the masks for a block stay in cache
+    // A block is as many whole reports as fit into blockLevels, or a single report if it is
+    // bigger than that on its own
+    constexpr size_t blockLevels = size_t(1) << 16;
+    std::vector<uint64_t> up;
+    std::vector<uint64_t> down;
+
+    size_t safeCount = 0;
+    size_t r = 0;
+    while (r < reportCount)
+    {
+        // Find the end of this block
+        size_t blockEnd = r + 1;
+        while (blockEnd < reportCount && offsets[blockEnd + 1] - offsets[r] <= blockLevels) blockEnd++;
+
+        // Build the masks for every pair in the block
+        const int* v = values + offsets[r];
+        const size_t levels = offsets[blockEnd] - offsets[r];
+        const size_t pairs = levels > 0 ? levels - 1 : 0;
+        up.assign(pairs / 64 + 1, 0);
+        down.assign(pairs / 64 + 1, 0);
+#ifdef AOC_HAS_AVX2_PATH
+        if (kernel == SafetyKernel::Avx2) stepMasksAvx2(v, pairs, up.data(), down.data());
+        else stepMasksScalar(v, 0, pairs, up.data(), down.data());
+#else
+        stepMasksScalar(v, 0, pairs, up.data(), down.data());
+#endif
+
+        // Now check each report's pairs against the masks
+        for (; r < blockEnd; r++)
+        {
+            const size_t first = offsets[r] - (v - values);
+            const size_t last = offsets[r + 1] - (v - values);
+            if (last - first < 2 || allBitsSet(up.data(), first, last - 1) || allBitsSet(down.data(), first, last - 1))
+            {
+                safe[r] = 1;
+                safeCount++;
+            }
+        }
+    }
+
+    return safeCount;
+}
@@ -0,0 +1,762 @@
+//********************************************************
+// Differential Fuzzer
+//
+// Throws random inputs at every fast engine, and checks
+// that each one gives exactly the same answer as a slow
+// reference that's written to be obviously right:
+// - Day 12: gardens, costed by a flood fill that counts
+//   fence sides by counting corners, against the Region
+//   and SoupRegion costs, the fence contours on both
+//   grid layouts, and the quadtree
+// - Day 11: lists of stones, blinked by counting every
+//   distinct stone in a plain map, against the stone
+//   engine and the stone batch, with both the compiled
+//   and the interpreted rules
+// - Day 2: reports, checked by trying every way of
+//   removing up to k levels, against both safety kernels
+//   and the dampener
+//
+// When an engine disagrees, its input is shrunk, one
+// small step at a time, for as long as it still
+// disagrees, and the smallest one is printed so it can be
+// pasted straight into a repro. The time every engine
+// takes over all of the cases is recorded too, so we can
+// see the speedup over the reference.
+//
+// Some engines are known to disagree with the reference,
+// and are marked as experimental. Their mismatches are
+// reported just the same, but only mismatches from the
+// other engines make the run fail.
+//
+// The same seed always gives the same inputs, so a run
+// that found something can be repeated exactly. A short
+// run with a fixed seed is registered with CTest as
+// diff_fuzz.
+//
+// Usage: DiffFuzz [--seed n] [--cases n] [--max-size n] [--target text]
+//********************************************************
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include "ScopedTimer.h"
+#include "ThreadPool.h"
+#include "Grid.h"
+#include "TiledGrid.h"
+#include "Reports.h"
+#include "SafetyKernel.h"
+#include "Dampener.h"
+#include "StoneRules.h"
+#include "StoneEngine.h"
+#include "StoneBatch.h"
+#include "BuildRules.h"
+#include "Day12.h"
+#include "Contours.h"
+#include "Quadtree.h"
+#include "References.h"
+
+// What an engine gives back when it throws, which never matches a real answer
+constexpr int64_t engineThrew = std::numeric_limits<int64_t>::min();
+
+// An engine under test
+// answer picks which of the reference's answers it has to match.
+template <typename Input>
+struct Engine
+{
+    std::string name;
+    size_t answer;
+    bool experimental;
+    std::function<int64_t(const Input&)> run;
+};
+
+// Everything the fuzzer needs to know about one kind of input
+// shrink() returns the inputs one step smaller than the one it's given, most promising first.
+template <typename Input>
+struct Target
+{
+    std::string name;
+    std::function<Input(std::mt19937&, int)> generate;
+    std::function<std::vector<int64_t>(const Input&)> reference;
+    std::function<std::vector<Input>(const Input&)> shrink;
+    std::function<std::string(const Input&)> describe;
+    std::vector<Engine<Input>> engines;
+    std::vector<Input> fixed;   // Inputs we know are tricky, which are checked before the random ones
+};
+
+// How an engine did over every case
+struct EngineReport
+{
+    uint64_t mismatches = 0;
+    double ms = 0.0;
+};
+
+// Forward declarations
+std::vector<Region> buildRegions(const Grid& garden);
+std::vector<int> makeExtremeReport(std::mt19937& random, int levels);
+
+//-------------------------------------------------------------------
+// Day 12
+//-------------------------------------------------------------------
+
+// A random N by N garden
+// Sometimes it's noise, and sometimes the letters are clumped together into bigger shapes, with
+// holes and corners that only just touch.
+Grid makeGarden(std::mt19937& random, int maxSize)
+{
+    const int N = 1 + static_cast<int>(random() % maxSize);
+    const int letters = 1 + static_cast<int>(random() % 4);
+    Grid garden(N, N);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            garden(i, j) = static_cast<char>('A' + random() % letters);
+        }
+    }
+
+    const int passes = static_cast<int>(random() % 4);
+    for (int pass = 0; pass < passes; pass++)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                const int k = static_cast<int>(random() % 4);
+                const int ni = i + (k == 0) - (k == 1);
+                const int nj = j + (k == 2) - (k == 3);
+                if (garden.inBounds(ni, nj)) garden(i, j) = garden(ni, nj);
+            }
+        }
+    }
+    return garden;
+}
+
+// The gardens one step smaller than a garden
+// They either lose a row and a column off of one side, so they stay square, or have a single
+// cell take the letter of one of its neighbours, which merges shapes together until only the
+// ones that matter are left.
+std::vector<Grid> shrinkGarden(const Grid& garden)
+{
+    const int N = garden.width();
+    std::vector<Grid> smaller;
+    if (N > 1)
+    {
+        for (const int offset : { 0, 1 })
+        {
+            Grid cropped(N - 1, N - 1);
+            for (int i = 0; i < N - 1; i++)
+            {
+                for (int j = 0; j < N - 1; j++)
+                {
+                    cropped(i, j) = garden(i + offset, j + offset);
+                }
+            }
+            smaller.push_back(std::move(cropped));
+        }
+    }
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            for (int d = 0; d < 4; d++)
+            {
+                const int ni = i + gridRowStep[d];
+                const int nj = j + gridColStep[d];
+                if (!garden.inBounds(ni, nj) || garden(ni, nj) == garden(i, j)) continue;
+                Grid merged = garden;
+                merged(i, j) = garden(ni, nj);
+                smaller.push_back(std::move(merged));
+            }
+        }
+    }
+    return smaller;
+}
+
+// A garden, as it would be written in an input file
+std::string describeGarden(const Grid& garden)
+{
+    std::string text;
+    for (int i = 0; i < garden.height(); i++)
+    {
+        text += "    ";
+        text += garden.row(i);
+        text += '\n';
+    }
+    return text;
+}
+
+// Add up a cost over every region or soup
+template <typename Regions, typename CostOf>
+int64_t totalCost(Regions& regions, CostOf costOf)
+{
+    int64_t total = 0;
+    for (auto& region : regions) total += costOf(region);
+    return total;
+}
+
+Target<Grid> gardenTarget()
+{
+    Target<Grid> target;
+    target.name = "day12";
+    target.generate = makeGarden;
+    target.reference = referenceGardenCosts;
+    target.shrink = shrinkGarden;
+    target.describe = describeGarden;
+
+    // The connected regions, costed one at a time
+    target.engines.push_back({ "region.cost", GardenCost, false, [](const Grid& garden)
+        {
+            std::vector<Region> regions = buildRegions(garden);
+            return totalCost(regions, [](Region& region) { return region.cost(); });
+        } });
+    target.engines.push_back({ "region.discountedCost", GardenDiscountedCost, false, [](const Grid& garden)
+        {
+            std::vector<Region> regions = buildRegions(garden);
+            return totalCost(regions, [](Region& region) { return region.discountedCost(); });
+        } });
+    target.engines.push_back({ "region.discountedCost2", GardenDiscountedCost, true, [](const Grid& garden)
+        {
+            std::vector<Region> regions = buildRegions(garden);
+            return totalCost(regions, [](Region& region) { return region.discountedCost2(); });
+        } });
+    target.engines.push_back({ "region.discountedCost3", GardenDiscountedCost, true, [](const Grid& garden)
+        {
+            std::vector<Region> regions = buildRegions(garden);
+            return totalCost(regions, [](Region& region) { return region.discountedCost3(); });
+        } });
+
+    // The soups, which is what Day12 itself runs
+    target.engines.push_back({ "soup.cost", GardenCost, false, [](const Grid& garden)
+        {
+            std::vector<SoupRegion> soups = buildSoupRegions(garden);
+            return totalCost(soups, [](SoupRegion& soup) { return soup.cost(); });
+        } });
+    target.engines.push_back({ "soup.discountedCost", GardenDiscountedCost, false, [](const Grid& garden)
+        {
+            std::vector<SoupRegion> soups = buildSoupRegions(garden);
+            return totalCost(soups, [](SoupRegion& soup) { return soup.discountedCost(); });
+        } });
+    target.engines.push_back({ "soup.discountedCost2", GardenDiscountedCost, true, [](const Grid& garden)
+        {
+            std::vector<SoupRegion> soups = buildSoupRegions(garden);
+            return totalCost(soups, [](SoupRegion& soup) { return soup.discountedCost2(); });
+        } });
+
+    // The fence contours, on both layouts, and the quadtree
+    target.engines.push_back({ "contours.grid.cost", GardenCost, false, [](const Grid& garden)
+        {
+            const std::vector<FencePolygon> fences = traceFences(garden);
+            return totalCost(fences, [](const FencePolygon& fence) { return fence.cost(); });
+        } });
+    target.engines.push_back({ "contours.grid.discountedCost", GardenDiscountedCost, false, [](const Grid& garden)
+        {
+            const std::vector<FencePolygon> fences = traceFences(garden);
+            return totalCost(fences, [](const FencePolygon& fence) { return fence.discountedCost(); });
+        } });
+    target.engines.push_back({ "contours.tiled.cost", GardenCost, false, [](const Grid& garden)
+        {
+            const std::vector<FencePolygon> fences = traceFences(TiledGrid(garden));
+            return totalCost(fences, [](const FencePolygon& fence) { return fence.cost(); });
+        } });
+    target.engines.push_back({ "contours.tiled.discountedCost", GardenDiscountedCost, false, [](const Grid& garden)
+        {
+            const std::vector<FencePolygon> fences = traceFences(TiledGrid(garden));
+            return totalCost(fences, [](const FencePolygon& fence) { return fence.discountedCost(); });
+        } });
+    target.engines.push_back({ "quadtree.cost", GardenCost, false, [](const Grid& garden)
+        {
+            return QuadGarden(garden).cost();
+        } });
+    return target;
+}
+
+//-------------------------------------------------------------------
+// Day 11
+//-------------------------------------------------------------------
+
+// A line of stones, and how many times to blink at it
+struct StoneCase
+{
+    std::vector<int64_t> stones;
+    int blinks = 0;
+};
+
+// The maximum number of blinks, which is as far as the counts can go without overflowing for
+// any line we make
+constexpr int maxFuzzBlinks = 60;
+
+// A random line of stones
+// The stones are a mix of tiny ones, ones with an even number of digits that split straight
+// away, and big ones, so every rule gets hit.
+StoneCase makeStones(std::mt19937& random, int maxSize)
+{
+    StoneCase stoneCase;
+    const int count = 1 + static_cast<int>(random() % std::max(1, maxSize / 2));
+    for (int i = 0; i < count; i++)
+    {
+        switch (random() % 3)
+        {
+        case 0: stoneCase.stones.push_back(random() % 10); break;
+        case 1: stoneCase.stones.push_back(1000 + random() % 9000); break;
+        default: stoneCase.stones.push_back(random() % 1000000000); break;
+        }
+    }
+    stoneCase.blinks = static_cast<int>(random() % (maxFuzzBlinks + 1));
+    return stoneCase;
+}
+
+// The lines of stones one step smaller than a line
+// They either lose a stone, blink fewer times, or have a stone lose its last digit.
+std::vector<StoneCase> shrinkStones(const StoneCase& stoneCase)
+{
+    std::vector<StoneCase> smaller;
+    if (stoneCase.stones.size() > 1)
+    {
+        for (size_t i = 0; i < stoneCase.stones.size(); i++)
+        {
+            StoneCase fewer = stoneCase;
+            fewer.stones.erase(fewer.stones.begin() + i);
+            smaller.push_back(std::move(fewer));
+        }
+    }
+    for (const int blinks : { stoneCase.blinks / 2, stoneCase.blinks - 1 })
+    {
+        if (blinks < 0 || blinks == stoneCase.blinks) continue;
+        StoneCase shorter = stoneCase;
+        shorter.blinks = blinks;
+        smaller.push_back(std::move(shorter));
+    }
+    for (size_t i = 0; i < stoneCase.stones.size(); i++)
+    {
+        if (stoneCase.stones[i] == 0) continue;
+        StoneCase simpler = stoneCase;
+        simpler.stones[i] /= 10;
+        smaller.push_back(std::move(simpler));
+    }
+    return smaller;
+}
+
+// A line of stones, as it would be written in an input file
+std::string describeStones(const StoneCase& stoneCase)
+{
+    std::string text = "    ";
+    for (size_t i = 0; i < stoneCase.stones.size(); i++)
+    {
+        if (i) text += ' ';
+        text += std::to_string(stoneCase.stones[i]);
+    }
+    return text + "\n    (after " + std::to_string(stoneCase.blinks) + " blinks)\n";
+}
+
+// Blink a line of stones with the stone engine
+template <typename Rules>
+int64_t engineCount(Rules rules, const StoneCase& stoneCase)
+{
+    StoneEngine<Rules> engine(std::move(rules));
+    for (const auto& stone : stoneCase.stones) engine.add(stone, 1);
+    for (int i = 0; i < stoneCase.blinks; i++) engine.blink();
+    return engine.count();
+}
+
+// Blink a line of stones with the stone batch
+template <typename Rules>
+int64_t batchCount(Rules rules, const StoneCase& stoneCase)
+{
+    StoneBatch<Rules> batch(std::move(rules), stoneCase.blinks);
+    return batch.count(stoneCase.stones.data(), stoneCase.stones.data() + stoneCase.stones.size());
+}
+
+Target<StoneCase> stoneTarget()
+{
+    // The interpreted rules are read in once, from the same file the compiled ones came from
+    const RuleSet interpreted = RuleSet::load(DAY11_RULES_FILE);
+
+    Target<StoneCase> target;
+    target.name = "day11";
+    target.generate = makeStones;
+    target.reference = [interpreted](const StoneCase& stoneCase)
+        {
+            return referenceStoneCounts(interpreted, stoneCase.stones, stoneCase.blinks);
+        };
+    target.shrink = shrinkStones;
+    target.describe = describeStones;
+    target.engines.push_back({ "engine.compiled", 0, false, [](const StoneCase& stoneCase) { return engineCount(BuildRules{}, stoneCase); } });
+    target.engines.push_back({ "engine.interpreted", 0, false, [interpreted](const StoneCase& stoneCase) { return engineCount(interpreted, stoneCase); } });
+    target.engines.push_back({ "batch.compiled", 0, false, [](const StoneCase& stoneCase) { return batchCount(BuildRules{}, stoneCase); } });
+    target.engines.push_back({ "batch.interpreted", 0, false, [interpreted](const StoneCase& stoneCase) { return batchCount(interpreted, stoneCase); } });
+    return target;
+}
+
+//-------------------------------------------------------------------
+// Day 2
+//-------------------------------------------------------------------
+
+// Some reports, and how many levels the dampener can remove from each
+struct ReportCase
+{
+    std::vector<std::vector<int>> reports;
+    int k = 1;
+};
+
+// The answers a list of reports has
+enum ReportAnswer { SafeReports = 0, DampenedReports = 1, SingleDampenedReports = 2 };
+
+// Random reports
+// Most of them mostly go one way in safe steps, with the odd bad step thrown in, so that a good
+// share of them are one or two removals away from being safe. The rest draw their levels from
+// the whole int range instead, see makeExtremeReport.
+ReportCase makeReports(std::mt19937& random, int maxSize)
+{
+    ReportCase reportCase;
+    reportCase.k = static_cast<int>(random() % 4);
+    const int count = 1 + static_cast<int>(random() % std::max(1, maxSize));
+    for (int r = 0; r < count; r++)
+    {
+        const int levels = 1 + static_cast<int>(random() % 10);
+        if (random() % 8 == 0)
+        {
+            reportCase.reports.push_back(makeExtremeReport(random, levels));
+            continue;
+        }
+
+        const int direction = random() % 2 == 0 ? 1 : -1;
+        int level = static_cast<int>(random() % 200) - 100;
+        std::vector<int> report;
+        for (int i = 0; i < levels; i++)
+        {
+            report.push_back(level);
+            level += random() % 5 == 0 ? static_cast<int>(random() % 11) - 5 : direction * (1 + static_cast<int>(random() % 3));
+        }
+        reportCase.reports.push_back(std::move(report));
+    }
+    return reportCase;
+}
+
+// A random report with levels from anywhere in the int range
+// Half of the levels are within a few of the lowest or highest int, so those end up right next
+// to each other, where a difference worked out in 32 bits wraps around to a small one. The
+// others are either anywhere at all, or a safe step on from the level before, so there are
+// still safe runs up against the ends of the range.
+std::vector<int> makeExtremeReport(std::mt19937& random, int levels)
+{
+    constexpr int lowest = std::numeric_limits<int>::min();
+    constexpr int highest = std::numeric_limits<int>::max();
+    std::vector<int> report;
+    for (int i = 0; i < levels; i++)
+    {
+        const int64_t step = (random() % 2 == 0 ? 1 : -1) * (1 + static_cast<int64_t>(random() % 3));
+        const int64_t stepped = report.empty() ? 0 : report.back() + step;
+        switch (random() % 4)
+        {
+        case 0: report.push_back(lowest + static_cast<int>(random() % 4)); break;
+        case 1: report.push_back(highest - static_cast<int>(random() % 4)); break;
+        case 2: report.push_back(static_cast<int>(random())); break;
+        default: report.push_back(report.empty() || stepped < lowest || stepped > highest ? static_cast<int>(random()) : static_cast<int>(stepped)); break;
+        }
+    }
+    return report;
+}
+
+// The report lists one step smaller than a list
+// They either lose a report, lose a level from a report, or let the dampener remove fewer levels.
+std::vector<ReportCase> shrinkReports(const ReportCase& reportCase)
+{
+    std::vector<ReportCase> smaller;
+    if (reportCase.reports.size() > 1)
+    {
+        for (size_t r = 0; r < reportCase.reports.size(); r++)
+        {
+            ReportCase fewer = reportCase;
+            fewer.reports.erase(fewer.reports.begin() + r);
+            smaller.push_back(std::move(fewer));
+        }
+    }
+    for (size_t r = 0; r < reportCase.reports.size(); r++)
+    {
+        if (reportCase.reports[r].size() <= 1) continue;
+        for (size_t i = 0; i < reportCase.reports[r].size(); i++)
+        {
+            ReportCase shorter = reportCase;
+            shorter.reports[r].erase(shorter.reports[r].begin() + i);
+            smaller.push_back(std::move(shorter));
+        }
+    }
+    if (reportCase.k > 0)
+    {
+        ReportCase stricter = reportCase;
+        stricter.k--;
+        smaller.push_back(std::move(stricter));
+    }
+    return smaller;
+}
+
+// Reports, as they would be written in an input file
+std::string reportText(const ReportCase& reportCase)
+{
+    std::string text;
+    for (const auto& report : reportCase.reports)
+    {
+        for (size_t i = 0; i < report.size(); i++)
+        {
+            if (i) text += ' ';
+            text += std::to_string(report[i]);
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+std::string describeReports(const ReportCase& reportCase)
+{
+    std::string text;
+    std::istringstream lines(reportText(reportCase));
+    for (std::string line; std::getline(lines, line);) text += "    " + line + "\n";
+    return text + "    (removing up to " + std::to_string(reportCase.k) + " levels)\n";
+}
+
+Target<ReportCase> reportTarget()
+{
+    Target<ReportCase> target;
+    target.name = "day2";
+    target.generate = makeReports;
+    target.reference = [](const ReportCase& reportCase)
+        {
+            std::vector<int64_t> counts(3, 0);
+            for (const auto& report : reportCase.reports)
+            {
+                counts[SafeReports] += isSafeReference(report, 0);
+                counts[DampenedReports] += isSafeReference(report, reportCase.k);
+                counts[SingleDampenedReports] += isSafeReference(report, 1);
+            }
+            return counts;
+        };
+    target.shrink = shrinkReports;
+    target.describe = describeReports;
+
+    // Levels at opposite ends of the range, whose difference doesn't fit in 32 bits, in reports
+    // long enough for the vector kernel to get to them
+    constexpr int lowest = std::numeric_limits<int>::min();
+    constexpr int highest = std::numeric_limits<int>::max();
+    target.fixed.push_back({ {
+        { lowest, highest },
+        { highest, lowest },
+        { lowest, highest, lowest, highest, lowest, highest, lowest, highest, lowest, highest },
+        { highest - 2, highest - 1, highest },
+        { lowest + 2, lowest + 1, lowest },
+        { 1, 2, 3, lowest, 4, 5, 6, 7, 8, 9 } }, 1 });
+
+    // Both safety kernels, on the whole batch
+    target.engines.push_back({ "kernel.scalar", SafeReports, false, [](const ReportCase& reportCase)
+        {
+            std::vector<uint8_t> safe;
+            return static_cast<int64_t>(classifyReports(Reports::parse(reportText(reportCase)), safe, SafetyKernel::Scalar));
+        } });
+#ifdef AOC_HAS_AVX2_PATH
+    if (AOC_CPU_HAS_AVX2())
+    {
+        target.engines.push_back({ "kernel.avx2", SafeReports, false, [](const ReportCase& reportCase)
+            {
+                std::vector<uint8_t> safe;
+                return static_cast<int64_t>(classifyReports(Reports::parse(reportText(reportCase)), safe, SafetyKernel::Avx2));
+            } });
+    }
+#endif
+
+    // The dampener, on the whole batch, and on one report at a time
+    target.engines.push_back({ "dampener.classify", DampenedReports, false, [](const ReportCase& reportCase)
+        {
+            std::vector<uint8_t> safe;
+            return static_cast<int64_t>(classifyReportsWithDampening(Reports::parse(reportText(reportCase)), reportCase.k, safe));
+        } });
+    target.engines.push_back({ "dampener.program", DampenedReports, false, [](const ReportCase& reportCase)
+        {
+            int64_t count = 0;
+            for (const auto& report : reportCase.reports) count += isReportSafeWithDampening(report, reportCase.k);
+            return count;
+        } });
+    target.engines.push_back({ "dampener.single_pass", SingleDampenedReports, false, [](const ReportCase& reportCase)
+        {
+            int64_t count = 0;
+            for (const auto& report : reportCase.reports) count += isReportSafeDampened(report);
+            return count;
+        } });
+    return target;
+}
+
+//-------------------------------------------------------------------
+// The fuzzing itself
+//-------------------------------------------------------------------
+
+// Run an engine, turning anything it throws into an answer that can't match
+template <typename Input>
+int64_t runEngine(const Engine<Input>& engine, const Input& input)
+{
+    try
+    {
+        return engine.run(input);
+    }
+    catch (const std::exception&)
+    {
+        return engineThrew;
+    }
+}
+
+// Shrink an input for as long as the engine still disagrees with the reference
+// Every step takes the first smaller input that still disagrees, so this always stops, and what's
+// left is a input where every single step smaller makes the disagreement go away.
+template <typename Input>
+Input minimise(const Target<Input>& target, const Engine<Input>& engine, Input input)
+{
+    bool shrunk = true;
+    while (shrunk)
+    {
+        shrunk = false;
+        for (auto& candidate : target.shrink(input))
+        {
+            if (runEngine(engine, candidate) != target.reference(candidate)[engine.answer])
+            {
+                input = std::move(candidate);
+                shrunk = true;
+                break;
+            }
+        }
+    }
+    return input;
+}
+
+// Fuzz every engine of a target
+// Returns the number of mismatches from engines that aren't experimental.
+template <typename Input>
+uint64_t fuzz(const Target<Input>& target, uint32_t seed, int cases, int maxSize)
+{
+    std::mt19937 random(seed);
+    double referenceMs = 0.0;
+    std::vector<EngineReport> reports(target.engines.size());
+    const int fixedCases = static_cast<int>(target.fixed.size());
+    for (int c = 0; c < fixedCases + cases; c++)
+    {
+        const Input input = c < fixedCases ? target.fixed[c] : target.generate(random, maxSize);
+
+        ScopedTimer timer;
+        const std::vector<int64_t> expected = target.reference(input);
+        referenceMs += timer.elapsed();
+
+        for (size_t e = 0; e < target.engines.size(); e++)
+        {
+            const Engine<Input>& engine = target.engines[e];
+            timer.restart();
+            const int64_t answer = runEngine(engine, input);
+            reports[e].ms += timer.elapsed();
+            if (answer == expected[engine.answer]) continue;
+
+            // Only the first mismatch is shrunk and printed, the rest are just counted
+            if (reports[e].mismatches++ == 0)
+            {
+                const Input repro = minimise(target, engine, input);
+                const int64_t reproAnswer = runEngine(engine, repro);
+                std::cout << target.name << " " << engine.name << " disagrees on case " << c << ", which shrinks to:" << std::endl;
+                std::cout << target.describe(repro);
+                std::cout << "    expected " << target.reference(repro)[engine.answer] << ", got ";
+                if (reproAnswer == engineThrew) std::cout << "an exception" << std::endl;
+                else std::cout << reproAnswer << std::endl;
+            }
+        }
+    }
+
+    // How every engine did, against the reference
+    uint64_t failures = 0;
+    std::cout << target.name << ": " << fixedCases + cases << " cases, reference took " << referenceMs << " ms" << std::endl;
+    for (size_t e = 0; e < target.engines.size(); e++)
+    {
+        const Engine<Input>& engine = target.engines[e];
+        std::cout << "  " << engine.name << ": " << reports[e].mismatches << " mismatches, " << reports[e].ms << " ms, "
+            << referenceMs / std::max(reports[e].ms, 1e-9) << "x the reference" << (engine.experimental ? " (experimental)" : "") << std::endl;
+        if (!engine.experimental) failures += reports[e].mismatches;
+    }
+    return failures;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t seed = 1;
+    int cases = 2000;
+    int maxSize = 12;
+    std::string filter;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (arg == "--cases" && i + 1 < argc) cases = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--max-size" && i + 1 < argc) maxSize = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--target" && i + 1 < argc) filter = argv[++i];
+        else
+        {
+            std::cerr << "Usage: DiffFuzz [--seed n] [--cases n] [--max-size n] [--target text]" << std::endl;
+            return 1;
+        }
+    }
+    setThreadCountFromEnvironment();
+
+    std::cout << "Fuzzing with seed " << seed << ", " << cases << " cases per target" << std::endl;
+    uint64_t failures = 0;
+    try
+    {
+        if (filter.empty() || std::string("day12").find(filter) != std::string::npos) failures += fuzz(gardenTarget(), seed, cases, maxSize);
+        if (filter.empty() || std::string("day11").find(filter) != std::string::npos) failures += fuzz(stoneTarget(), seed, cases, maxSize);
+        if (filter.empty() || std::string("day2").find(filter) != std::string::npos) failures += fuzz(reportTarget(), seed, cases, maxSize);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (failures > 0)
+    {
+        std::cout << failures << " mismatches from engines that should match the reference" << std::endl;
+        return 1;
+    }
+    std::cout << "Every engine that should match the reference does" << std::endl;
+    return 0;
+}
+
+// Every connected region of a garden, as Regions
+std::vector<Region> buildRegions(const Grid& garden)
+{
+    const int N = garden.width();
+    std::vector<bool> seen(garden.size(), false);
+    std::vector<Region> regions;
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            if (seen[garden.index(i, j)]) continue;
+
+            Region region(garden(i, j), unique(i, j, N), N);
+            std::vector<std::pair<int, int>> stack = { { i, j } };
+            seen[garden.index(i, j)] = true;
+            while (!stack.empty())
+            {
+                const auto [r, c] = stack.back();
+                stack.pop_back();
+                for (int d = 0; d < 4; d++)
+                {
+                    const int nr = r + gridRowStep[d];
+                    const int nc = c + gridColStep[d];
+                    if (!garden.inBounds(nr, nc) || garden(nr, nc) != garden(i, j) || seen[garden.index(nr, nc)]) continue;
+                    seen[garden.index(nr, nc)] = true;
+                    region.add(unique(nr, nc, N));
+                    stack.push_back({ nr, nc });
+                }
+            }
+            regions.push_back(std::move(region));
+        }
+    }
+    return regions;
+}
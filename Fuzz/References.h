@@ -0,0 +1,132 @@
+//********************************************************
+// References
+//
+// Slow implementations of every puzzle, written straight
+// from the definitions so that they're obviously right.
+// The fuzzer checks the fast engines' answers against
+// them, and the performance check times the fast engines
+// against them.
+//********************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Grid.h"
+#include "StoneRules.h"
+
+// The answers a garden has
+enum GardenAnswer { GardenCost = 0, GardenDiscountedCost = 1 };
+
+// The costs of a garden, straight from the definitions
+// Every region is flood filled, its perimeter is the number of cell sides that don't face
+// another cell of the region, and its number of sides is its number of corners. Each cell has a
+// corner at each of its own four corners if both of the cells beside it there are outside the
+// region (an outside corner), or both are inside but the one diagonally across isn't (an inside
+// corner).
+inline std::vector<int64_t> referenceGardenCosts(const Grid& garden)
+{
+    const int N = garden.width();
+    std::vector<int> region(garden.size(), -1);
+    std::vector<int64_t> costs(2, 0);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            if (region[garden.index(i, j)] != -1) continue;
+
+            const int label = i * N + j;
+            const char letter = garden(i, j);
+            auto inRegion = [&](int r, int c) { return garden.inBounds(r, c) && garden(r, c) == letter; };
+
+            int64_t area = 0, perimeter = 0, corners = 0;
+            std::vector<std::pair<int, int>> stack = { { i, j } };
+            region[garden.index(i, j)] = label;
+            while (!stack.empty())
+            {
+                const auto [r, c] = stack.back();
+                stack.pop_back();
+                area++;
+                for (int d = 0; d < 4; d++)
+                {
+                    const int nr = r + gridRowStep[d];
+                    const int nc = c + gridColStep[d];
+                    if (!inRegion(nr, nc))
+                    {
+                        perimeter++;
+                    }
+                    else if (region[garden.index(nr, nc)] == -1)
+                    {
+                        region[garden.index(nr, nc)] = label;
+                        stack.push_back({ nr, nc });
+                    }
+
+                    // The corner between this direction and the next one around
+                    const int e = (d + 1) % 4;
+                    const bool first = inRegion(nr, nc);
+                    const bool second = inRegion(r + gridRowStep[e], c + gridColStep[e]);
+                    const bool diagonal = inRegion(r + gridRowStep[d] + gridRowStep[e], c + gridColStep[d] + gridColStep[e]);
+                    if ((!first && !second) || (first && second && !diagonal)) corners++;
+                }
+            }
+            costs[GardenCost] += area * perimeter;
+            costs[GardenDiscountedCost] += area * corners;
+        }
+    }
+    return costs;
+}
+
+// The number of stones after some blinks, keeping a count of every distinct stone in a map
+// The rules are the interpreted ones, read in from the rules file, as that's the specification.
+inline std::vector<int64_t> referenceStoneCounts(const RuleSet& rules, const std::vector<int64_t>& stones, int blinks)
+{
+    std::map<int64_t, int64_t> counts;
+    for (const auto& stone : stones) counts[stone]++;
+    for (int blink = 0; blink < blinks; blink++)
+    {
+        std::map<int64_t, int64_t> next;
+        for (const auto& [stone, count] : counts)
+        {
+            const EvolvedState evolved = rules(stone);
+            if (evolved.overflowed) throw std::runtime_error("count overflows");
+            for (int i = 0; i < evolved.count; i++) next[evolved.stones[i]] += count;
+        }
+        counts = std::move(next);
+    }
+
+    int64_t total = 0;
+    for (const auto& [stone, count] : counts) total += count;
+    return { total };
+}
+
+// Is a report safe if we can remove up to k of its levels?
+// Every way of removing levels is tried, from removing nothing up to removing k of them.
+inline bool isSafeReference(const std::vector<int>& levels, int k)
+{
+    auto isSafe = [](const std::vector<int>& v)
+        {
+            bool increasing = true, decreasing = true;
+            // The difference is worked out in 64 bits, as two ints can be further apart than an
+            // int can hold
+            for (size_t i = 1; i < v.size(); i++)
+            {
+                const int64_t d = static_cast<int64_t>(v[i]) - v[i - 1];
+                increasing = increasing && d >= 1 && d <= 3;
+                decreasing = decreasing && d >= -3 && d <= -1;
+            }
+            return increasing || decreasing;
+        };
+
+    if (isSafe(levels)) return true;
+    if (k <= 0) return false;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        std::vector<int> removed = levels;
+        removed.erase(removed.begin() + i);
+        if (isSafeReference(removed, k - 1)) return true;
+    }
+    return false;
+}
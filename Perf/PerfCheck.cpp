@@ -0,0 +1,517 @@
+//********************************************************
+// Performance Check
+//
+// Runs every solver on fixed synthetic inputs, at a few
+// different sizes, next to a slow reference for the same
+// puzzle (see References.h), and checks:
+// - how long it takes as a fraction of the reference's
+//   time on the same input, in the same process, so that
+//   the check doesn't depend on how fast the machine is
+// - the number of allocations made in a run, counted by
+//   the allocation hook in Allocations.h
+// - the answer, which has to match the reference's
+//
+// A case fails if its time ratio, or its allocations,
+// are worse than the stored baseline (baseline.json) by
+// more than the threshold (25% unless the baseline or the
+// command line says otherwise), or if its answer is
+// wrong. Any failure makes the whole check fail, so it
+// can be used as a gate before merging anything that
+// touches a hot path.
+//
+// Engines the fuzzer knows to disagree with the reference
+// (see DiffFuzz.cpp) are marked experimental. They're
+// timed like the others, but their answers aren't checked,
+// and the baseline never records answers at all.
+//
+// It's still a timing check, so it isn't part of the
+// default CTest run. Configuring with AOC_PERF_CHECK_TEST
+// registers it as perf_check, run with the
+// PERF_CHECK_BASELINE and PERF_CHECK_THRESHOLD cache
+// variables.
+//
+// The baseline should be rewritten with --write-baseline
+// whenever a speedup is accepted. It's specific to the
+// parallel backend (see Parallel.h) and the build
+// configuration it was written with, as optimization
+// changes the ratios, so any other build only has its
+// answers checked.
+//
+// Usage: PerfCheck [--baseline file] [--threshold fraction] [--repeats n]
+//                  [--filter text] [--write-baseline]
+//********************************************************
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include "ScopedTimer.h"
+#include "Allocations.h"
+#include "ThreadPool.h"
+#include "Parallel.h"
+#include "SumAbsDiff.h"
+#include "RadixSort.h"
+#include "Similarity.h"
+#include "Reports.h"
+#include "SafetyKernel.h"
+#include "Dampener.h"
+#include "StoneEngine.h"
+#include "BuildRules.h"
+#include "Day12.h"
+#include "References.h"
+
+// Forward declarations
+struct Measurement;
+std::map<std::string, Measurement> readBaseline(const std::string& filename, double& threshold, std::string& backend, std::string& config);
+bool writeBaseline(const std::string& filename, double threshold, const std::map<std::string, Measurement>& results);
+
+// How a case did
+struct Measurement
+{
+    double medianMs = 0.0;
+    double referenceMs = 0.0;
+    double ratio = 0.0;         // medianMs / referenceMs
+    uint64_t allocations = 0;
+    int64_t result = 0;
+    int64_t expected = 0;       // The reference's answer
+};
+
+// A case, ready to run
+// Both runs work on their own copy of the same input, and return the answer.
+struct PreparedCase
+{
+    std::function<int64_t()> run;
+    std::function<int64_t()> reference;
+};
+
+// A case to check
+// prepare() builds the input, outside of the timing, and returns the runs to time
+struct PerfCase
+{
+    std::string name;
+    bool experimental;  // Known to disagree with the reference, so its answer isn't checked
+    std::function<PreparedCase()> prepare;
+};
+
+// Two columns of random Day 1 numbers
+void makeColumns(size_t rows, std::vector<int>& column1, std::vector<int>& column2)
+{
+    std::mt19937 random(static_cast<uint32_t>(rows));
+    std::uniform_int_distribution<int> digits(10000, 99999);
+    column1.resize(rows);
+    column2.resize(rows);
+    for (size_t i = 0; i < rows; i++)
+    {
+        column1[i] = digits(random);
+        column2[i] = digits(random);
+    }
+}
+
+// Random Day 2 reports, as text, with a mix of safe and unsafe reports
+std::string makeReports(size_t count)
+{
+    std::mt19937 random(static_cast<uint32_t>(count));
+    std::string text;
+    for (size_t r = 0; r < count; r++)
+    {
+        const int levels = 5 + static_cast<int>(random() % 4);
+        const int direction = random() % 2 == 0 ? 1 : -1;
+        int level = 10 + static_cast<int>(random() % 80);
+        for (int i = 0; i < levels; i++)
+        {
+            text += std::to_string(level);
+            text += i + 1 < levels ? ' ' : '\n';
+            level += random() % 8 == 0 ? static_cast<int>(random() % 9) - 4 : direction * (1 + static_cast<int>(random() % 3));
+        }
+    }
+    return text;
+}
+
+// A random N by N garden, with blobs of the same letter rather than noise
+Grid makeGarden(int N)
+{
+    std::mt19937 random(static_cast<uint32_t>(N));
+    Grid garden(N, N);
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            garden(i, j) = static_cast<char>('A' + random() % 6);
+        }
+    }
+
+    // Let each cell copy a neighbour a few times over, so the letters clump together
+    for (int pass = 0; pass < 4; pass++)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                const int k = static_cast<int>(random() % 4);
+                const int ni = i + (k == 0) - (k == 1);
+                const int nj = j + (k == 2) - (k == 3);
+                if (garden.inBounds(ni, nj)) garden(i, j) = garden(ni, nj);
+            }
+        }
+    }
+    return garden;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string baselineFile = PERF_BASELINE_FILE;
+    double threshold = -1.0;
+    int repeats = 5;
+    std::string filter;
+    bool write = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--baseline" && i + 1 < argc) baselineFile = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc) threshold = std::stod(argv[++i]);
+        else if (arg == "--repeats" && i + 1 < argc) repeats = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--write-baseline") write = true;
+        else
+        {
+            std::cerr << "Usage: PerfCheck [--baseline file] [--threshold fraction] [--repeats n] [--filter text] [--write-baseline]" << std::endl;
+            return 1;
+        }
+    }
+    setThreadCountFromEnvironment();
+
+    //----------------------------------------------------
+    // The cases
+    // Each is big enough to take tens of milliseconds, so that timer noise and a cold start
+    // don't swamp it
+    //----------------------------------------------------
+    std::vector<PerfCase> cases;
+    for (const size_t rows : { size_t(1000000), size_t(4000000) })
+    {
+        cases.push_back({ "day1.sort_similarity." + std::to_string(rows), false, [rows]
+            {
+                std::vector<int> column1, column2;
+                makeColumns(rows, column1, column2);
+                PreparedCase prepared;
+                prepared.run = [column1, column2]() mutable
+                    {
+                        radixSortColumns(column1, column2);
+                        return static_cast<int64_t>(sumAbsDiff(column1, column2)) ^ similarityScore(column1, column2);
+                    };
+
+                // Sort with std::sort, and count the right column in a map
+                prepared.reference = [column1, column2]() mutable
+                    {
+                        std::sort(column1.begin(), column1.end());
+                        std::sort(column2.begin(), column2.end());
+                        int64_t distance = 0;
+                        std::map<int, int64_t> appearances;
+                        for (size_t i = 0; i < column1.size(); i++)
+                        {
+                            distance += std::abs(static_cast<int64_t>(column1[i]) - column2[i]);
+                            appearances[column2[i]]++;
+                        }
+                        int64_t similarity = 0;
+                        for (const int value : column1)
+                        {
+                            const auto it = appearances.find(value);
+                            if (it != appearances.end()) similarity += value * it->second;
+                        }
+                        return distance ^ similarity;
+                    };
+                return prepared;
+            } });
+    }
+    for (const size_t count : { size_t(100000), size_t(1000000) })
+    {
+        cases.push_back({ "day2.classify." + std::to_string(count), false, [count]
+            {
+                const std::string text = makeReports(count);
+                PreparedCase prepared;
+                prepared.run = [text]
+                    {
+                        const Reports reports = Reports::parse(text);
+                        std::vector<uint8_t> safe;
+                        const size_t safeCount = classifyReports(reports, safe);
+                        const size_t dampenedCount = classifyReportsWithDampening(reports, 1, safe, safeCount);
+                        return static_cast<int64_t>(safeCount * 1000000 + dampenedCount);
+                    };
+
+                // Read every report with a string stream, and try every single removal
+                prepared.reference = [text]
+                    {
+                        std::istringstream lines(text);
+                        int64_t safeCount = 0, dampenedCount = 0;
+                        for (std::string line; std::getline(lines, line);)
+                        {
+                            std::istringstream words(line);
+                            std::vector<int> report;
+                            for (int level; words >> level;) report.push_back(level);
+                            safeCount += isSafeReference(report, 0);
+                            dampenedCount += isSafeReference(report, 1);
+                        }
+                        return safeCount * 1000000 + dampenedCount;
+                    };
+                return prepared;
+            } });
+    }
+    const RuleSet interpreted = RuleSet::load(DAY11_RULES_FILE);
+    for (const size_t count : { size_t(10000), size_t(100000) })
+    {
+        cases.push_back({ "day11.blink." + std::to_string(count), false, [count, &interpreted]
+            {
+                std::mt19937 random(static_cast<uint32_t>(count));
+                std::vector<int64_t> stones(count);
+                for (auto& stone : stones) stone = random() % 1000000000;
+                PreparedCase prepared;
+                prepared.run = [stones]
+                    {
+                        StoneEngine<BuildRules> engine{ BuildRules{} };
+                        for (const auto& stone : stones) engine.add(stone, 1);
+                        for (int i = 0; i < 75; i++) engine.blink();
+                        return engine.count();
+                    };
+                prepared.reference = [stones, &interpreted]
+                    {
+                        return referenceStoneCounts(interpreted, stones, 75)[0];
+                    };
+                return prepared;
+            } });
+    }
+    struct CostCase
+    {
+        std::string name;
+        GardenAnswer answer;
+        bool experimental;
+        std::function<int(SoupRegion&)> costOf;
+    };
+    const CostCase costs[] = {
+        { "cost", GardenCost, false, [](SoupRegion& soup) { return soup.cost(); } },
+        { "discounted", GardenDiscountedCost, false, [](SoupRegion& soup) { return soup.discountedCost(); } },
+        { "discounted2", GardenDiscountedCost, true, [](SoupRegion& soup) { return soup.discountedCost2(); } },
+    };
+    for (const int N : { 128, 256 })
+    {
+        for (const auto& cost : costs)
+        {
+            cases.push_back({ "day12." + cost.name + "." + std::to_string(N), cost.experimental, [N, cost]
+                {
+                    const Grid garden = makeGarden(N);
+                    PreparedCase prepared;
+                    prepared.run = [garden, cost]
+                        {
+                            std::vector<SoupRegion> soups = buildSoupRegions(garden);
+                            int64_t total = 0;
+                            for (auto& soup : soups) total += cost.costOf(soup);
+                            return total;
+                        };
+                    prepared.reference = [garden, cost]
+                        {
+                            return referenceGardenCosts(garden)[cost.answer];
+                        };
+                    return prepared;
+                } });
+        }
+    }
+
+    //----------------------------------------------------
+    // Run them all
+    // The case and its reference take turns, so anything that slows the machine down for a
+    // while slows both of them down
+    //----------------------------------------------------
+    std::map<std::string, Measurement> results;
+    std::map<std::string, bool> experimental;
+    for (const auto& perfCase : cases)
+    {
+        if (!filter.empty() && perfCase.name.find(filter) == std::string::npos) continue;
+
+        const PreparedCase prepared = perfCase.prepare();
+        std::vector<double> times, referenceTimes;
+        Measurement measurement;
+        for (int repeat = 0; repeat < repeats; repeat++)
+        {
+            // Every run gets a fresh copy of the prepared input, as some of them work in place
+            auto run = prepared.run;
+            const uint64_t allocationsBefore = allocationTotals().allocations;
+            ScopedTimer timer;
+            measurement.result = run();
+            times.push_back(timer.elapsed());
+            measurement.allocations = allocationTotals().allocations - allocationsBefore;
+
+            auto reference = prepared.reference;
+            ScopedTimer referenceTimer;
+            measurement.expected = reference();
+            referenceTimes.push_back(referenceTimer.elapsed());
+        }
+        std::sort(times.begin(), times.end());
+        std::sort(referenceTimes.begin(), referenceTimes.end());
+        measurement.medianMs = times[times.size() / 2];
+        measurement.referenceMs = referenceTimes[referenceTimes.size() / 2];
+        measurement.ratio = measurement.medianMs / std::max(measurement.referenceMs, 1e-6);
+        results[perfCase.name] = measurement;
+        experimental[perfCase.name] = perfCase.experimental;
+    }
+
+    //----------------------------------------------------
+    // Compare against the baseline
+    //----------------------------------------------------
+    double baselineThreshold = 0.25;
+    std::string baselineBackend, baselineConfig;
+    const auto baseline = readBaseline(baselineFile, baselineThreshold, baselineBackend, baselineConfig);
+    if (threshold < 0.0) threshold = baselineThreshold;
+
+    if (write)
+    {
+        if (!writeBaseline(baselineFile, threshold, results)) return 1;
+        std::cout << "Wrote " << results.size() << " cases to " << baselineFile << std::endl;
+        return 0;
+    }
+
+    // A handful of extra allocations always pass (thread pools warming up, and so on)
+    const uint64_t allocationSlack = 16;
+
+    // Ratios and allocations from another backend, or another build configuration, say nothing
+    // about this one
+    const bool sameBackend = baselineBackend.empty() || baselineBackend == parallelBackendName;
+    const bool sameConfig = baselineConfig == PERF_BUILD_CONFIG;
+    if (!sameBackend && !baseline.empty())
+    {
+        std::cout << "The baseline is for the " << baselineBackend << " backend and this build uses " << parallelBackendName << ", so only the answers are checked" << std::endl;
+    }
+    else if (!sameConfig && !baseline.empty())
+    {
+        std::cout << "The baseline is for a '" << baselineConfig << "' build and this is a '" << PERF_BUILD_CONFIG << "' build, so only the answers are checked" << std::endl;
+    }
+
+    int failures = 0;
+    for (const auto& [name, measurement] : results)
+    {
+        std::cout << name << ": " << measurement.medianMs << " ms, " << measurement.ratio << "x the reference's " << measurement.referenceMs << " ms, " << measurement.allocations << " allocations";
+
+        std::vector<std::string> problems;
+        if (!experimental[name] && measurement.result != measurement.expected)
+        {
+            problems.push_back("answer " + std::to_string(measurement.result) + " != " + std::to_string(measurement.expected));
+        }
+        const auto it = baseline.find(name);
+        if (it != baseline.end() && sameBackend && sameConfig)
+        {
+            const Measurement& expected = it->second;
+            if (measurement.ratio > expected.ratio * (1.0 + threshold))
+            {
+                problems.push_back("ratio was " + std::to_string(expected.ratio));
+            }
+            if (measurement.allocations > static_cast<uint64_t>(expected.allocations * (1.0 + threshold)) + allocationSlack)
+            {
+                problems.push_back("allocations were " + std::to_string(expected.allocations));
+            }
+        }
+
+        if (!problems.empty())
+        {
+            failures++;
+            std::cout << " [FAIL:";
+            for (const auto& problem : problems) std::cout << " " << problem << ";";
+            std::cout << "]" << std::endl;
+        }
+        else if (it == baseline.end())
+        {
+            std::cout << " [NEW]" << std::endl;
+        }
+        else
+        {
+            std::cout << " [OK, baseline " << it->second.ratio << "x" << (experimental[name] ? ", experimental so the answer isn't checked" : "") << "]" << std::endl;
+        }
+    }
+
+    std::cout << results.size() - failures << " of " << results.size() << " cases passed, with a threshold of " << threshold * 100 << "%" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// Read a baseline written by writeBaseline
+// Only the format written below is understood: the threshold, the backend and the build
+// configuration on their own lines, then one line per case. A missing file is just an empty
+// baseline, and a baseline without a backend is assumed to be for this one.
+std::map<std::string, Measurement> readBaseline(const std::string& filename, double& threshold, std::string& backend, std::string& config)
+{
+    std::map<std::string, Measurement> baseline;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Warning: No baseline at " << filename << ", every case is new" << std::endl;
+        return baseline;
+    }
+
+    // The number after a key on a line, if the key is there
+    auto valueOf = [](const std::string& line, const std::string& key, double& value)
+        {
+            const size_t at = line.find("\"" + key + "\":");
+            if (at == std::string::npos) return false;
+            value = std::strtod(line.c_str() + at + key.size() + 3, nullptr);
+            return true;
+        };
+
+    // The quoted string after a key on a line, if the key is there
+    auto stringOf = [](const std::string& line, const std::string& key, std::string& value)
+        {
+            const size_t at = line.find("\"" + key + "\":");
+            if (at == std::string::npos) return false;
+            const size_t first = line.find('"', at + key.size() + 3);
+            const size_t last = first == std::string::npos ? std::string::npos : line.find('"', first + 1);
+            if (last != std::string::npos) value = line.substr(first + 1, last - first - 1);
+            return true;
+        };
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        double value;
+        if (valueOf(line, "threshold", value))
+        {
+            threshold = value;
+            continue;
+        }
+        if (stringOf(line, "backend", backend) || stringOf(line, "config", config)) continue;
+
+        const size_t nameStart = line.find('"');
+        const size_t nameEnd = nameStart == std::string::npos ? std::string::npos : line.find('"', nameStart + 1);
+        if (nameEnd == std::string::npos || !valueOf(line, "ratio", value)) continue;
+
+        Measurement measurement;
+        measurement.ratio = value;
+        if (valueOf(line, "allocations", value)) measurement.allocations = static_cast<uint64_t>(value);
+        baseline[line.substr(nameStart + 1, nameEnd - nameStart - 1)] = measurement;
+    }
+    return baseline;
+}
+
+// Save the results as the new baseline
+// Only the ratios and allocations are kept, the answers always come from the reference.
+bool writeBaseline(const std::string& filename, double threshold, const std::map<std::string, Measurement>& results)
+{
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write baseline to " << filename << std::endl;
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"threshold\": " << threshold << ",\n";
+    file << "  \"backend\": \"" << parallelBackendName << "\",\n";
+    file << "  \"config\": \"" << PERF_BUILD_CONFIG << "\",\n";
+    file << "  \"cases\": {\n";
+    size_t written = 0;
+    for (const auto& [name, measurement] : results)
+    {
+        file << "    \"" << name << "\": { \"ratio\": " << measurement.ratio << ", \"allocations\": " << measurement.allocations << " }";
+        file << (++written < results.size() ? ",\n" : "\n");
+    }
+    file << "  }\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,70 @@
+//********************************************************
+// AoC Client
+//
+// Sends a batch of requests to a running AocServer, and
+// prints the answers, one per line, in the same order.
+//
+// The requests come from the command line, one argument
+// each, or from standard input, one per line, if there
+// aren't any. See Workspace.h for what can be asked.
+//
+// Usage: AocClient [--socket path] [request ...]
+//   e.g. AocClient "garden big garden.txt" "cost big"
+//********************************************************
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Socket.h"
+#include "ScopedTimer.h"
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath = defaultSocketPath;
+    std::string batch;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else batch += arg + "\n";
+    }
+
+    // No requests on the command line, so read them in
+    if (batch.empty())
+    {
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            batch += line + "\n";
+        }
+    }
+
+    ScopedTimer timer;
+    std::string responses;
+    try
+    {
+        const int connection = connectTo(socketPath);
+        const bool ok = sendAll(connection, batch) && ::shutdown(connection, SHUT_WR) == 0 && receiveAll(connection, responses);
+        ::close(connection);
+        if (!ok) {
+            std::cerr << "Error: Lost the connection to " << socketPath << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const double elapsed = timer.elapsed();
+
+    // Print the answers, and fail if any of them were errors
+    bool failed = false;
+    for (const auto& response : splitLines(responses))
+    {
+        std::cout << response << std::endl;
+        failed = failed || response.rfind("error:", 0) == 0;
+    }
+    std::cerr << "Round trip: " << elapsed << " ms" << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+//********************************************************
+// AoC Server
+//
+// A long running server that keeps gardens and stones in
+// memory (see Workspace.h), so that questions about them
+// can be answered without paying for starting a process,
+// parsing the input, and building the tables every time.
+//
+// It listens on a Unix domain socket. Every connection is
+// one batch of requests (see Socket.h), and connections
+// are handed out to a pool of worker threads. Within a
+// batch, the requests that load or drop things are done
+// first, in order, and then all of the queries are
+// answered in parallel.
+//
+// Sending "shutdown" stops the server.
+//
+// Usage: AocServer [--socket path] [--workers n]
+//********************************************************
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include "Socket.h"
+#include "Workspace.h"
+#include "Parallel.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "Allocations.h"
+
+// Forward declarations
+std::vector<std::string> answerBatch(Workspace& workspace, const std::vector<std::string>& requests, bool& shutdown);
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath = defaultSocketPath;
+    int workers = 4;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) workers = std::max(1, std::stoi(argv[++i]));
+        else
+        {
+            std::cerr << "Usage: AocServer [--socket path] [--workers n]" << std::endl;
+            return 1;
+        }
+    }
+    setThreadCountFromEnvironment();
+
+    int listener = -1;
+    try
+    {
+        listener = listenOn(socketPath);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << socketPath << " with " << workers << " workers" << std::endl;
+
+    Workspace workspace;
+    std::atomic<bool> stopping = false;
+
+    // Accepted connections wait here until a worker is free
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<int> connections;
+
+    auto serve = [&]()
+        {
+            while (true)
+            {
+                int connection;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueReady.wait(lock, [&] { return !connections.empty() || stopping; });
+                    if (connections.empty()) return;
+                    connection = connections.front();
+                    connections.pop_front();
+                }
+
+                // Read the whole batch, answer it, and send the answers back
+                // A client that takes too long to send it gets an error instead
+                std::string batch;
+                bool shutdown = false;
+                if (receiveAll(connection, batch, batchTimeoutMs))
+                {
+                    std::string responses;
+                    for (const auto& response : answerBatch(workspace, splitLines(batch), shutdown))
+                    {
+                        responses += response;
+                        responses += '\n';
+                    }
+                    sendAll(connection, responses);
+                }
+                else
+                {
+                    sendAll(connection, "error: could not read the requests\n");
+                }
+                ::close(connection);
+
+                // Wake the accept loop up, so it sees that we're stopping
+                if (shutdown && !stopping.exchange(true))
+                {
+                    ::shutdown(listener, SHUT_RDWR);
+                    queueReady.notify_all();
+                }
+            }
+        };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; i++)
+    {
+        pool.emplace_back(serve);
+    }
+
+    // Hand every connection to the pool, until we're told to stop
+    while (!stopping)
+    {
+        const int connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            connections.push_back(connection);
+        }
+        queueReady.notify_one();
+    }
+
+    stopping = true;
+    queueReady.notify_all();
+    for (auto& worker : pool)
+    {
+        worker.join();
+    }
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+
+    std::cout << "Stopped" << std::endl;
+    AOC_ALLOC_REPORT(std::cout);
+    AOC_TRACE_SAVE("AocServer_trace.json");
+    return 0;
+}
+
+// Answer every request in a batch, in the same order they came in
+// Loads and drops go first, one at a time, then the queries are answered in parallel. A
+// shutdown request sets shutdown, and is answered once the rest of the batch has been.
+std::vector<std::string> answerBatch(Workspace& workspace, const std::vector<std::string>& requests, bool& shutdown)
+{
+    AOC_TRACE_SCOPE("batch", static_cast<int64_t>(requests.size()));
+    std::vector<std::string> responses(requests.size());
+    std::vector<size_t> queries;
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        if (requests[i] == "shutdown")
+        {
+            shutdown = true;
+            responses[i] = "ok";
+        }
+        else if (Workspace::changesState(requests[i]))
+        {
+            responses[i] = workspace.handle(requests[i]);
+        }
+        else
+        {
+            queries.push_back(i);
+        }
+    }
+
+    parallelFor(0, queries.size(), 1, [&](size_t first, size_t last)
+        {
+            for (size_t q = first; q < last; q++)
+            {
+                responses[queries[q]] = workspace.handle(requests[queries[q]]);
+            }
+        });
+    return responses;
+}
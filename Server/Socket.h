@@ -0,0 +1,150 @@
+//********************************************************
+// Socket
+//
+// The small amount of Unix domain socket plumbing that the
+// server and its client share.
+//
+// The protocol is plain text. A client connects, writes a
+// batch of requests, one per line, and then shuts down
+// its side of the connection. The server answers every
+// request with exactly one line, in the same order, and
+// then closes the connection. See Workspace.h for the
+// requests themselves.
+//
+// A client that connects and then never finishes sending
+// its batch would hold on to a server worker for ever, so
+// the server only waits so long for a whole batch.
+//********************************************************
+
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Where the server listens unless told otherwise
+constexpr const char* defaultSocketPath = "/tmp/aoc.sock";
+
+// The most a single batch of requests can be, so a bad client can't make the server
+// buffer forever
+constexpr size_t maxBatchBytes = size_t(64) << 20;
+
+// The longest the server waits for a whole batch of requests to arrive
+constexpr int batchTimeoutMs = 30000;
+
+// Fill in a socket address for a path
+// Throws if the path is too long to fit
+inline sockaddr_un socketAddress(const std::string& path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Start listening on a socket at path, replacing any stale socket left there
+// Throws if the socket can't be set up
+inline int listenOn(const std::string& path)
+{
+    const sockaddr_un address = socketAddress(path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        const std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Could not listen on " + path + ": " + error);
+    }
+    return fd;
+}
+
+// Connect to the socket at path
+// Throws if nothing is listening there
+inline int connectTo(const std::string& path)
+{
+    const sockaddr_un address = socketAddress(path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Could not connect to " + path + ": " + error);
+    }
+    return fd;
+}
+
+// Write all of data to a socket
+// Returns false if the other end went away first
+inline bool sendAll(int fd, std::string_view data)
+{
+    while (!data.empty())
+    {
+        const ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+// Read from a socket until the other end shuts down its side
+// Returns false on an error, if there's more than maxBatchBytes, or if it all takes longer than
+// timeoutMs (a negative timeout waits for as long as it takes)
+inline bool receiveAll(int fd, std::string& data, int timeoutMs = -1)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    char buffer[65536];
+    while (true)
+    {
+        // Wait for something to read, for however much of the timeout is left
+        if (timeoutMs >= 0)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return false;
+            pollfd waiting = { fd, POLLIN, 0 };
+            const int ready = ::poll(&waiting, 1, static_cast<int>(left));
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) return false;
+        }
+
+        const ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0) return false;
+        if (received == 0) return true;
+        if (data.size() + static_cast<size_t>(received) > maxBatchBytes) return false;
+        data.append(buffer, static_cast<size_t>(received));
+    }
+}
+
+// Split text into its lines, dropping any carriage returns and blank lines
+inline std::vector<std::string> splitLines(std::string_view text)
+{
+    std::vector<std::string> lines;
+    while (!text.empty())
+    {
+        const size_t newline = text.find('\n');
+        std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") != std::string_view::npos) lines.emplace_back(line);
+    }
+    return lines;
+}
@@ -0,0 +1,289 @@
+//********************************************************
+// Workspace
+//
+// Everything the server keeps in memory between requests:
+// - gardens (Day 12), with their soup regions built and
+//   the fencing costs of every soup already worked out
+// - stone lists (Day 11), each with its own stone engine
+//   whose lookup table stays warm, and the stone count
+//   after every blink it has been asked for so far
+//
+// Each is loaded once, under a name, and every request
+// after that is a lookup. Requests are one line each:
+//
+//   garden <name> <file>          load a garden
+//   stones <name> <file>          load a list of stones
+//   cost <name> [letter]          regular fencing cost
+//   discounted <name> [letter]    discounted cost
+//   discounted2 <name> [letter]   Katie's discounted cost
+//   blinks <name> <count>         stones after count blinks
+//   list                          everything that's loaded
+//   drop <name>                   forget a garden or stones
+//
+// Each request gets back a single line, which is either
+// the answer, or starts with "error:".
+//
+// Loading replaces whatever was under that name. Queries
+// hold on to what they're reading, so they're never
+// blocked by a load, and never see half of one.
+//********************************************************
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "FastParse.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "ScopedTimer.h"
+#include "Trace.h"
+#include "StoneEngine.h"
+#include "BuildRules.h"
+#include "Day12.h"
+
+// The most blinks a query can ask for
+// The counts overflow long before this, and those queries get an error back (see
+// StoneEngine.h). It's just so that one request can't keep a worker busy forever.
+constexpr int maxServedBlinks = 1000;
+
+//-------------------------------------------------------------------
+// A garden that has been loaded, with everything we need to answer
+// cost queries about it
+//-------------------------------------------------------------------
+struct LoadedGarden
+{
+    // The kinds of cost we know how to work out
+    enum Cost { Regular = 0, Discounted = 1, Discounted2 = 2, CostCount = 3 };
+
+    Grid garden;
+    std::vector<SoupRegion> soups;
+    std::vector<std::array<int64_t, CostCount>> soupCosts;  // Every soup's costs, in the same order as soups
+    std::array<int64_t, CostCount> totals = {};
+    double loadMs = 0.0;
+};
+
+//-------------------------------------------------------------------
+// A list of stones that has been loaded, along with the engine that
+// blinks them
+//-------------------------------------------------------------------
+struct LoadedStones
+{
+    explicit LoadedStones(BuildRules rules) : engine(std::move(rules)) {};
+
+    // The engine can only do one blink at a time, so it's only used while this is held
+    std::mutex mutex;
+    StoneEngine<BuildRules> engine;
+    std::vector<int64_t> counts;    // counts[i] is how many stones there are after i blinks
+    bool overflowed = false;        // The count after counts.size() blinks doesn't fit in 64 bits
+};
+
+class Workspace
+{
+public:
+
+    // Does this request change what's loaded?
+    // Those have to be done in order, before any of the queries that come after them.
+    static bool changesState(const std::string& request)
+    {
+        std::istringstream words(request);
+        std::string command;
+        words >> command;
+        return command == "garden" || command == "stones" || command == "drop";
+    };
+
+    // Answer a single request
+    // Never throws, anything that goes wrong becomes an error response
+    std::string handle(const std::string& request)
+    {
+        try
+        {
+            std::istringstream words(request);
+            std::string command, name;
+            words >> command >> name;
+
+            if (command == "garden" || command == "stones")
+            {
+                // Filenames can have spaces in them, so it's the rest of the line
+                std::string filename;
+                std::getline(words >> std::ws, filename);
+                if (name.empty() || filename.empty()) return "error: usage is " + command + " <name> <file>";
+                return command == "garden" ? loadGarden(name, filename) : loadStones(name, filename);
+            }
+            if (command == "cost" || command == "discounted" || command == "discounted2")
+            {
+                const LoadedGarden::Cost which = command == "cost" ? LoadedGarden::Regular : command == "discounted" ? LoadedGarden::Discounted : LoadedGarden::Discounted2;
+                std::string letter;
+                words >> letter;
+                return gardenCost(name, which, letter);
+            }
+            if (command == "blinks")
+            {
+                // Anything that isn't just a number would otherwise be read as 0 blinks
+                int blinks = -1;
+                std::string trailing;
+                if (!(words >> blinks) || words >> trailing) return "error: usage is blinks <name> <count>";
+                return stonesAfter(name, blinks);
+            }
+            if (command == "list") return list();
+            if (command == "drop") return drop(name);
+            return "error: unknown request '" + command + "'";
+        }
+        catch (const std::exception& e)
+        {
+            return std::string("error: ") + e.what();
+        }
+    };
+
+private:
+
+    // Load a garden, build its soups, and cost all of them up front
+    // Costing a soup shuffles its coordinates around while it works, so they're all done here,
+    // once, rather than by queries that could be running at the same time.
+    std::string loadGarden(const std::string& name, const std::string& filename)
+    {
+        AOC_TRACE_SCOPE("load garden");
+        ScopedTimer timer;
+        auto loaded = std::make_shared<LoadedGarden>();
+        loaded->garden = Grid::load(filename);
+        if (loaded->garden.width() != loaded->garden.height()) {
+            throw std::runtime_error("Gardens have to be square");
+        }
+        loaded->soups = buildSoupRegions(loaded->garden);
+
+        loaded->soupCosts.resize(loaded->soups.size());
+        parallelFor(0, loaded->soups.size(), 1, [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                {
+                    SoupRegion& soup = loaded->soups[i];
+                    loaded->soupCosts[i] = { soup.cost(), soup.discountedCost(), soup.discountedCost2() };
+                }
+            });
+        for (const auto& costs : loaded->soupCosts)
+        {
+            for (int c = 0; c < LoadedGarden::CostCount; c++) loaded->totals[c] += costs[c];
+        }
+        loaded->loadMs = timer.elapsed();
+
+        const size_t soupCount = loaded->soups.size();
+        const double loadMs = loaded->loadMs;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            stones_.erase(name);
+            gardens_[name] = std::move(loaded);
+        }
+        std::ostringstream response;
+        response << "ok " << soupCount << " soups in " << loadMs << " ms";
+        return response.str();
+    };
+
+    // Load a list of stones, ready to blink
+    std::string loadStones(const std::string& name, const std::string& filename)
+    {
+        AOC_TRACE_SCOPE("load stones");
+        MappedFile file(filename);
+        if (!file.isOpen()) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+
+        auto loaded = std::make_shared<LoadedStones>(BuildRules{});
+        IntegerScanner scanner(file.view());
+        int64_t stone;
+        int64_t count = 0;
+        while (scanner.next(stone))
+        {
+            loaded->engine.add(stone, 1);
+            count++;
+        }
+        loaded->counts.push_back(count);
+
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            gardens_.erase(name);
+            stones_[name] = std::move(loaded);
+        }
+        return "ok " + std::to_string(count) + " stones";
+    };
+
+    // A cost of a garden, either the total or for the soup of one letter
+    std::string gardenCost(const std::string& name, LoadedGarden::Cost which, const std::string& letter) const
+    {
+        const auto loaded = find(gardens_, name);
+        if (!loaded) return "error: no garden called '" + name + "'";
+        if (letter.empty()) return std::to_string(loaded->totals[which]);
+
+        for (size_t i = 0; i < loaded->soups.size(); i++)
+        {
+            if (letter.size() == 1 && loaded->soups[i].letter() == letter[0]) return std::to_string(loaded->soupCosts[i][which]);
+        }
+        return "error: no '" + letter + "' in garden '" + name + "'";
+    };
+
+    // The number of stones after some number of blinks
+    // The engine only ever moves forwards, so every count it passes is kept, and asking for one
+    // we've already passed is just a lookup. Once a count overflows, so does every count after
+    // it, so the engine stops there.
+    std::string stonesAfter(const std::string& name, int blinks) const
+    {
+        const auto loaded = find(stones_, name);
+        if (!loaded) return "error: no stones called '" + name + "'";
+        if (blinks < 0 || blinks > maxServedBlinks) return "error: blinks must be between 0 and " + std::to_string(maxServedBlinks);
+
+        // Blinking runs in parallel while we hold the lock, so it's isolated (see Parallel.h)
+        std::lock_guard<std::mutex> lock(loaded->mutex);
+        parallelIsolate([&]
+            {
+                while (static_cast<int>(loaded->counts.size()) <= blinks && !loaded->overflowed)
+                {
+                    loaded->engine.blink();
+                    int64_t count = 0;
+                    if (!loaded->engine.checkedCount(count)) {
+                        loaded->overflowed = true;
+                        break;
+                    }
+                    loaded->counts.push_back(count);
+                }
+            });
+        if (static_cast<int>(loaded->counts.size()) <= blinks) return "error: count overflows";
+        return std::to_string(loaded->counts[blinks]);
+    };
+
+    // Everything that's loaded, by name
+    std::string list() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::string response = "gardens:";
+        for (const auto& [name, loaded] : gardens_) response += " " + name;
+        response += " stones:";
+        for (const auto& [name, loaded] : stones_) response += " " + name;
+        return response;
+    };
+
+    // Forget about a garden or stones
+    std::string drop(const std::string& name)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const size_t dropped = gardens_.erase(name) + stones_.erase(name);
+        return dropped > 0 ? "ok" : "error: nothing called '" + name + "'";
+    };
+
+    // Look up something by name, keeping it alive for as long as the caller needs it
+    template <typename T>
+    std::shared_ptr<T> find(const std::map<std::string, std::shared_ptr<T>>& loaded, const std::string& name) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const auto it = loaded.find(name);
+        return it == loaded.end() ? nullptr : it->second;
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, std::shared_ptr<LoadedGarden>> gardens_;
+    std::map<std::string, std::shared_ptr<LoadedStones>> stones_;
+};